@@ -0,0 +1,47 @@
+#!/usr/bin/env python3
+"""Compares the run time of a program built without and with --bounds-check, and
+counts the checks left after optimization.
+
+Usage: bench/bounds.py [path/to/jlc] [program.jl]
+"""
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+here = os.path.dirname(os.path.abspath(__file__))
+jlc = sys.argv[1] if len(sys.argv) > 1 else os.path.join(here, "..", "jlc")
+program = sys.argv[2] if len(sys.argv) > 2 else os.path.join(here, "bounds_kernels.jl")
+runs = 10
+
+
+def measure(exe):
+    """Best wall time in seconds of running exe"""
+    best = None
+    for _ in range(runs):
+        start = time.perf_counter()
+        subprocess.run([exe], check=True, stdout=subprocess.DEVNULL)
+        elapsed = time.perf_counter() - start
+        best = elapsed if best is None else min(best, elapsed)
+    return best
+
+
+def remaining_checks(flags):
+    """Calls to indexOutOfBounds in the optimized IR"""
+    ir = subprocess.run([jlc, "-O2", *flags, program], check=True,
+                        capture_output=True, text=True).stdout
+    return ir.count("call void @indexOutOfBounds")
+
+
+with tempfile.TemporaryDirectory() as tmp:
+    print(f"{'build':<15} {'time (s)':>9} {'checks left':>12}")
+    baseline = None
+    for name, flags in [("unchecked", []), ("--bounds-check", ["--bounds-check"])]:
+        exe = os.path.join(tmp, "bench")
+        subprocess.run([jlc, "-O2", *flags, "-o", exe, program], check=True,
+                       stderr=subprocess.DEVNULL, stdout=subprocess.DEVNULL)
+        elapsed = measure(exe)
+        baseline = baseline or elapsed
+        overhead = f"  ({(elapsed / baseline - 1) * 100:+.1f}%)" if flags else ""
+        print(f"{name:<15} {elapsed:>9.3f} {remaining_checks(flags):>12}{overhead}")
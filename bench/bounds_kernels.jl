@@ -0,0 +1,82 @@
+// Array kernels for the cost of --bounds-check (see bench/bounds.py). The loops run
+// while the index is below the length, the pattern whose checks are removed again.
+int main() {
+    int n = 200;
+    double[][] a = new double[n][n];
+    double[][] b = new double[n][n];
+    double[][] c = new double[n][n];
+    double x = 0.0;
+    int i = 0;
+    while (i < a.length) {
+        int j = 0;
+        while (j < a[i].length) {
+            a[i][j] = x;
+            b[i][j] = 1.0 - x;
+            x = x + 0.001;
+            j++;
+        }
+        i++;
+    }
+
+    int round = 0;
+    while (round < 5) {
+        multiply(a, b, c);
+        round++;
+    }
+
+    int[] sieve = new int[5000000];
+    int primes = 0;
+    int rep = 0;
+    while (rep < 5) {
+        primes = primes + countPrimes(sieve);
+        rep++;
+    }
+
+    double total = 0.0;
+    for (double[] row : c)
+        for (double x : row)
+            total = total + x;
+    printDouble(total);
+    printInt(primes);
+    return 0;
+}
+
+void multiply(double[][] a, double[][] b, double[][] c) {
+    int i = 0;
+    while (i < c.length) {
+        int j = 0;
+        while (j < c[i].length) {
+            double sum = 0.0;
+            int k = 0;
+            while (k < a[i].length) {
+                sum = sum + a[i][k] * b[k][j];
+                k++;
+            }
+            c[i][j] = sum;
+            j++;
+        }
+        i++;
+    }
+}
+
+int countPrimes(int[] composite) {
+    int i = 0;
+    while (i < composite.length) {
+        composite[i] = 0;
+        i++;
+    }
+    int count = 0;
+    i = 2;
+    while (i < composite.length) {
+        if (composite[i] == 0) {
+            count++;
+            int j = i + i;
+            while (j < composite.length) {
+                composite[j] = 1;
+                j = j + i;
+            }
+        }
+        i++;
+    }
+    return count;
+}
@@ -0,0 +1,41 @@
+#!/usr/bin/env python3
+"""Compares peak RSS and run time of a program built with the default allocator
+(which never frees), --arena and --gc.
+
+Usage: bench/gc.py [path/to/jlc] [program.jl]
+"""
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+here = os.path.dirname(os.path.abspath(__file__))
+jlc = sys.argv[1] if len(sys.argv) > 1 else os.path.join(here, "..", "jlc")
+program = sys.argv[2] if len(sys.argv) > 2 else os.path.join(here, "gc_churn.jl")
+runs = 5
+
+
+def measure(exe):
+    """Best wall time in seconds and peak RSS in MiB of running exe"""
+    best, rss = None, 0
+    for _ in range(runs):
+        start = time.perf_counter()
+        process = subprocess.Popen([exe], stdout=subprocess.DEVNULL)
+        _, status, usage = os.wait4(process.pid, 0)
+        elapsed = time.perf_counter() - start
+        if status != 0:
+            sys.exit(f"{exe} failed with status {status}")
+        best = elapsed if best is None else min(best, elapsed)
+        rss = max(rss, usage.ru_maxrss / 1024)
+    return best, rss
+
+
+with tempfile.TemporaryDirectory() as tmp:
+    print(f"{'allocator':<10} {'time (s)':>9} {'peak RSS (MiB)':>15}")
+    for name, flags in [("default", []), ("--arena", ["--arena"]), ("--gc", ["--gc"])]:
+        exe = os.path.join(tmp, "bench")
+        subprocess.run([jlc, "-O2", *flags, "-o", exe, program], check=True,
+                       stderr=subprocess.DEVNULL, stdout=subprocess.DEVNULL)
+        elapsed, rss = measure(exe)
+        print(f"{name:<10} {elapsed:>9.3f} {rss:>15.1f}")
@@ -0,0 +1,37 @@
+// Allocation churn for the garbage collector (see bench/gc.py). Keeps a window of
+// 1000 live rows of a matrix while replacing them with fresh arrays, so that almost
+// everything allocated becomes garbage soon after.
+int main() {
+    int rows = 1000;
+    int[][] window = new int[rows][16];
+    int round = 0;
+    int checksum = 0;
+    while (round < 2000) {
+        int i = 0;
+        while (i < rows) {
+            window[i] = fill(16 + i % 64, round + i);
+            i++;
+        }
+        checksum = (checksum + sum(window[round % rows])) % 1000003;
+        round++;
+    }
+    printInt(checksum);
+    return 0;
+}
+
+int[] fill(int n, int seed) {
+    int[] a = new int[n];
+    int i = 0;
+    while (i < n) {
+        a[i] = seed + i;
+        i++;
+    }
+    return a;
+}
+
+int sum(int[] a) {
+    int s = 0;
+    for (int x : a)
+        s = s + x;
+    return s;
+}
@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+"""Compares the time to build an executable of a program with many functions at
+-j 1, 2, 4 and 8.
+
+Usage: bench/jobs.py [path/to/jlc] [functions]
+"""
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+here = os.path.dirname(os.path.abspath(__file__))
+jlc = sys.argv[1] if len(sys.argv) > 1 else os.path.join(here, "..", "jlc")
+functions = int(sys.argv[2]) if len(sys.argv) > 2 else 4000
+runs = 3
+
+
+def program():
+    """Functions with a few loops over an array each, all called once by main.
+    They are too large for -O2 to inline, which would otherwise only happen with
+    -j1, where main and the functions are in the same module."""
+    lines = []
+    for i in range(functions):
+        lines += [f"int f{i}(int[] a, int n) {{", "  int s = n;"]
+        for k in range(4):
+            lines += [
+                "  for (int x : a) {",
+                f"    if (x % {i % 7 + k + 2} == 0) s = s + x * {i + k};",
+                f"    else if (x > s) s = s - x / {k + 1};",
+                "    else s = s + 1;",
+                "  }",
+            ]
+        lines += ["  return s;", "}"]
+    lines += ["int main() {", "  int[] a = new int[100];", "  int s = 0;"]
+    lines += [f"  s = s + f{i}(a, {i});" for i in range(functions)]
+    lines += ["  printInt(s);", "  return 0;", "}"]
+    return "\n".join(lines) + "\n"
+
+
+def measure(flags, source, output):
+    """Best wall time in seconds of building source"""
+    best = None
+    for _ in range(runs):
+        start = time.perf_counter()
+        subprocess.run([jlc, "-O2", *flags, "-o", output, source], check=True,
+                       stderr=subprocess.DEVNULL)
+        elapsed = time.perf_counter() - start
+        best = elapsed if best is None else min(best, elapsed)
+    return best
+
+
+with tempfile.TemporaryDirectory() as tmp:
+    source = os.path.join(tmp, "many.jl")
+    with open(source, "w") as f:
+        f.write(program())
+    output = os.path.join(tmp, "many")
+
+    print(f"{'jobs':<6} {'time (s)':>9}")
+    baseline = None
+    for jobs in [1, 2, 4, 8]:
+        elapsed = measure([f"-j{jobs}"], source, output)
+        baseline = baseline or elapsed
+        speedup = f"  ({baseline / elapsed:.2f}x)" if jobs > 1 else ""
+        print(f"{jobs:<6} {elapsed:>9.3f}{speedup}")
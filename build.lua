@@ -12,6 +12,9 @@ function find_replace()
     --
     content = string.gsub(content, "error:", "ERROR:")
     content = string.gsub(content, "Bison.H", "bnfc/Bison.H")
+    -- Allocate the nodes in the parser's arena (src/Common/Arena.h)
+    content = string.gsub(content, "new bnfc::([%w_]+)%(", "jlc::make<bnfc::%1>(")
+    content = string.gsub(content, "#include \"Absyn.H\"", "#include \"Absyn.H\"\n#include \"../src/Common/Arena.h\"", 1)
 
     --
     -- Write it out
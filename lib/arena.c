@@ -0,0 +1,40 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/mman.h>
+
+// Bump allocator for the arrays of a Javalette program, replacing the calloc-based
+// jlc_alloc of the runtime when linked in (jlc --arena). Arrays are never freed, so
+// memory is handed out from large chunks mapped from the OS. The chunks are fresh
+// anonymous pages, which are already zeroed. Javalette programs are single-threaded,
+// and the JIT can't allocate thread-locals, so the bump pointer is a plain global.
+
+#define CHUNK_SIZE (64 << 20)
+
+static char* next;
+static char* end;
+
+static void* mapPages(size_t bytes)
+{
+    void* pages = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return pages == MAP_FAILED ? NULL : pages;
+}
+
+// Nothing is traced, so pointerBytes doesn't matter
+void* jlc_alloc(size_t bytes, size_t pointerBytes)
+{
+    bytes = (bytes + 15) & ~(size_t)15;
+    if (bytes > (size_t)(end - next)) {
+        // Big arrays get their own mapping, so that the current chunk isn't wasted
+        if (bytes > CHUNK_SIZE / 4)
+            return mapPages(bytes);
+        char* chunk = mapPages(CHUNK_SIZE);
+        if (chunk == NULL)
+            return NULL;
+        next = chunk;
+        end = chunk + CHUNK_SIZE;
+    }
+    void* p = next;
+    next += bytes;
+    return p;
+}
@@ -0,0 +1,56 @@
+; Bump allocator for the arrays of a Javalette program, see lib/arena.c
+
+@next = internal global i8* null
+@end = internal global i8* null
+
+declare i8* @mmap(i8*, i64, i32, i32, i32, i64)
+
+; PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE (Linux)
+define internal i8* @mapPages(i64 %bytes) {
+entry:
+  %pages = call i8* @mmap(i8* null, i64 %bytes, i32 3, i32 16418, i32 -1, i64 0)
+  %failed = icmp eq i8* %pages, inttoptr (i64 -1 to i8*)
+  %result = select i1 %failed, i8* null, i8* %pages
+  ret i8* %result
+}
+
+define noalias i8* @jlc_alloc(i64 %bytes, i64 %pointerBytes) {
+entry:
+  %padded = add i64 %bytes, 15
+  %rounded = and i64 %padded, -16
+  %next = load i8*, i8** @next
+  %end = load i8*, i8** @end
+  %nextInt = ptrtoint i8* %next to i64
+  %endInt = ptrtoint i8* %end to i64
+  %left = sub i64 %endInt, %nextInt
+  %fits = icmp ule i64 %rounded, %left
+  br i1 %fits, label %bump, label %full
+
+full:
+  %big = icmp ugt i64 %rounded, 16777216
+  br i1 %big, label %own, label %chunk
+
+; Big arrays get their own mapping, so that the current chunk isn't wasted
+own:
+  %pages = call i8* @mapPages(i64 %rounded)
+  ret i8* %pages
+
+chunk:
+  %chunkStart = call i8* @mapPages(i64 67108864)
+  %noChunk = icmp eq i8* %chunkStart, null
+  br i1 %noChunk, label %outOfMemory, label %newChunk
+
+outOfMemory:
+  ret i8* null
+
+newChunk:
+  %chunkEnd = getelementptr inbounds i8, i8* %chunkStart, i64 67108864
+  store i8* %chunkEnd, i8** @end
+  br label %bump
+
+bump:
+  %p = phi i8* [ %next, %entry ], [ %chunkStart, %newChunk ]
+  %bumped = getelementptr inbounds i8, i8* %p, i64 %rounded
+  store i8* %bumped, i8** @next
+  ret i8* %p
+}
@@ -0,0 +1,155 @@
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Mark-sweep collector for the arrays of a Javalette program, replacing the calloc-based
+// jlc_alloc of the runtime when linked in (jlc --gc). Unlike the other runtime objects
+// it is compiled from C by the system compiler (see 'make runtime').
+//
+// The roots are the array variables of each call, which jlc --gc registers on LLVM's
+// shadow stack. Arrays that are only held in registers or spill slots for a moment,
+// e.g. an argument while the next one is evaluated, are found by conservatively
+// scanning the native stack. Arrays are traced through their rows, and any pointer
+// into an array (such as a row of a multi-dimensional one) keeps all of it alive.
+
+// The frames of LLVM's "shadow-stack" GC strategy, emitted by the code generator
+typedef struct FrameMap {
+    int32_t numRoots;
+    int32_t numMeta;
+    const void* meta[];
+} FrameMap;
+
+typedef struct StackEntry {
+    struct StackEntry* next;
+    const FrameMap* map;
+    void* roots[];
+} StackEntry;
+
+// Defined by every module with shadow stack frames, weak here for those without
+__attribute__((weak)) StackEntry* llvm_gc_root_chain;
+
+// The bottom of the main thread's stack, from glibc
+extern void* __libc_stack_end;
+
+// Header in front of each array
+typedef struct Object {
+    size_t size;         // Bytes of the array
+    size_t pointerBytes; // Leading bytes of the array that may point to other arrays
+    size_t marked;
+    size_t padding;      // Keeps the arrays 16-byte aligned
+} Object;
+
+// Collect after allocating as many bytes as were live after the last collection,
+// but at least this many
+#ifndef MIN_THRESHOLD
+#define MIN_THRESHOLD (8 << 20)
+#endif
+
+static Object** objects; // Sorted by address during a collection
+static size_t numObjects, maxObjects;
+static Object** markStack;
+static size_t markStackSize, maxMarkStack;
+static size_t allocated; // Bytes allocated since the last collection
+static size_t threshold = MIN_THRESHOLD;
+
+static void* grow(void* array, size_t* capacity, size_t elementSize)
+{
+    *capacity = *capacity ? *capacity * 2 : 1024;
+    void* grown = realloc(array, *capacity * elementSize);
+    if (grown == NULL)
+        abort();
+    return grown;
+}
+
+static int compareAddresses(const void* a, const void* b)
+{
+    uintptr_t x = (uintptr_t) * (Object* const*)a, y = (uintptr_t) * (Object* const*)b;
+    return x < y ? -1 : x > y;
+}
+
+// Marks the array that p points into, if any
+static void mark(void* p)
+{
+    char* address = p;
+    size_t low = 0, high = numObjects;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if ((char*)(objects[middle] + 1) <= address)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    if (low == 0)
+        return;
+    Object* object = objects[low - 1];
+    if (object->marked || address >= (char*)(object + 1) + object->size)
+        return;
+    object->marked = 1;
+    if (markStackSize == maxMarkStack)
+        markStack = grow(markStack, &maxMarkStack, sizeof(Object*));
+    markStack[markStackSize++] = object;
+}
+
+static void markRange(void** from, void** to)
+{
+    for (void** p = from; p < to; p++)
+        mark(*p);
+}
+
+// Not inlined, so that the scan covers the frames of all callers
+__attribute__((noinline)) static void markStackAndRegisters(void)
+{
+    // Spills all callee-saved registers to this frame. setjmp alone isn't enough, as
+    // glibc mangles some of them (rbp on x86-64) in the jmp_buf.
+    __builtin_unwind_init();
+    jmp_buf registers; // setjmp spills the callee-saved registers in here
+    setjmp(registers);
+    markRange((void**)&registers, (void**)__libc_stack_end);
+}
+
+static void collect(void)
+{
+    qsort(objects, numObjects, sizeof(Object*), compareAddresses);
+
+    for (StackEntry* entry = llvm_gc_root_chain; entry; entry = entry->next)
+        markRange(entry->roots, entry->roots + entry->map->numRoots);
+    markStackAndRegisters();
+    while (markStackSize > 0) {
+        Object* object = markStack[--markStackSize];
+        char* array = (char*)(object + 1);
+        markRange((void**)array, (void**)(array + object->pointerBytes));
+    }
+
+    size_t live = 0, kept = 0;
+    for (size_t i = 0; i < numObjects; i++) {
+        Object* object = objects[i];
+        if (!object->marked) {
+            free(object);
+            continue;
+        }
+        object->marked = 0;
+        live += object->size;
+        objects[kept++] = object;
+    }
+    numObjects = kept;
+    allocated = 0;
+    threshold = live > MIN_THRESHOLD ? live : MIN_THRESHOLD;
+}
+
+void* jlc_alloc(size_t bytes, size_t pointerBytes)
+{
+    if (allocated >= threshold)
+        collect();
+
+    Object* object = calloc(1, sizeof(Object) + bytes);
+    if (object == NULL)
+        return NULL;
+    object->size = bytes;
+    object->pointerBytes = pointerBytes;
+
+    if (numObjects == maxObjects)
+        objects = grow(objects, &maxObjects, sizeof(Object*));
+    objects[numObjects++] = object;
+    allocated += bytes;
+    return object + 1;
+}
@@ -1,36 +1,77 @@
-
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
 
-typedef struct MultiArray_T {
+// An array is one object, its length followed by the elements at their natural
+// alignment, like struct { int32_t length; T data[]; }. The elements of an outer
+// dimension are pointers to the arrays of its rows.
+typedef struct Array_T {
     int32_t length;
-    void* ptr;
-} MultiArray;
+} Array;
 
-MultiArray* newMultiArray(int32_t len, void* ptrTo)
+// Zeroed memory for arrays, of which the first pointerBytes may hold pointers to
+// other arrays. Linking lib/arena.o or lib/gc.o replaces it.
+__attribute__((weak)) void* jlc_alloc(size_t bytes, size_t pointerBytes)
 {
-    MultiArray* array = malloc(sizeof(MultiArray));
-    array->length = len;
-    array->ptr = ptrTo;
-    return array;
+    return calloc(1, bytes);
 }
 
-MultiArray* multiArray(int32_t n, int32_t size, int32_t* dimList)
+// Called by the checks of jlc --bounds-check
+__attribute__((cold, noreturn)) void indexOutOfBounds(int32_t index, int32_t length)
 {
-    int len = dimList[0];
+    fprintf(stderr, "ERROR: Index %d out of bounds for length %d\n", index, length);
+    exit(1);
+}
 
-    if (n == 1) {
-        void* content = calloc(len, size);
-        return newMultiArray(len, content);
-    }
+// Offset of the elements of an array with elements of the given size
+static size_t payloadOffset(size_t size)
+{
+    return size > sizeof(int32_t) ? size : sizeof(int32_t);
+}
 
-    void** span = malloc(len * sizeof(void*));
+// Size of an array of len elements, rounded up so that the next one is aligned
+static size_t arraySize(size_t len, size_t size)
+{
+    size_t bytes = payloadOffset(size) + len * size;
+    return (bytes + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+}
 
-    for (int i = 0; i < len; i++) {
-        span[i] = multiArray(n - 1, size, &dimList[1]);
+// Allocates an n-dimensional array as one zeroed block, holding the arrays of each
+// dimension one level after the other. The elements of the last dimension are
+// contiguous in row-major order, as in a C array. The rows are still arrays of
+// their own that can be reassigned, which is why the outer levels point to them.
+Array* multiArray(int32_t n, int32_t size, int32_t* dimList)
+{
+    size_t bytes = 0, pointerBytes = 0, count = 1;
+    for (int k = 0; k < n; k++) {
+        size_t rowSize = k == n - 1 ? size : sizeof(void*);
+        pointerBytes = bytes; // All but the last level are rows
+        bytes += count * arraySize(dimList[k], rowSize);
+        count *= dimList[k];
     }
 
-    MultiArray array = { .length = len, .ptr = span };
-    return newMultiArray(len, span);
-}
\ No newline at end of file
+    char* level = jlc_alloc(bytes, pointerBytes);
+    Array* array = (Array*)level;
+    count = 1;
+    for (int k = 0; k < n; k++) {
+        size_t len = dimList[k];
+        size_t levelSize = arraySize(len, k == n - 1 ? size : sizeof(void*));
+        char* next = level + count * levelSize;
+        size_t nextSize =
+            k + 1 < n ? arraySize(dimList[k + 1], k + 1 == n - 1 ? size : sizeof(void*))
+                      : 0;
+
+        for (size_t j = 0; j < count; j++) {
+            char* row = level + j * levelSize;
+            ((Array*)row)->length = len;
+            if (k < n - 1) {
+                char** rows = (char**)(row + payloadOffset(sizeof(void*)));
+                for (size_t i = 0; i < len; i++)
+                    rows[i] = next + (j * len + i) * nextSize;
+            }
+        }
+        level = next;
+        count *= len;
+    }
+    return array;
+}
@@ -3,9 +3,13 @@
 @d   = internal constant [3 x i8] c"%d\00"
 @lf  = internal constant [4 x i8] c"%lf\00"
 
+@oob = internal constant [45 x i8] c"ERROR: Index %d out of bounds for length %d\0A\00"
+
 declare i32 @printf(i8*, ...)
 declare i32 @scanf(i8*, ...)
 declare i32 @puts(i8*)
+declare i32 @dprintf(i32, i8*, ...)
+declare void @exit(i32) noreturn
 
 define void @printInt(i32 %x) {
 entry: %t0 = getelementptr [4 x i8], [4 x i8]* @dnl, i32 0, i32 0
@@ -40,94 +44,136 @@ entry:	%res = alloca double
 	ret double %t2
 }
 
-%struct.MultiArray_T = type { i32, i8* }
-
-; Function Attrs: mustprogress nofree nounwind sspstrong uwtable willreturn
-define dso_local noalias %struct.MultiArray_T* @newMultiArray(i32 %0, i8* %1) local_unnamed_addr #0 {
-  %3 = tail call noalias align 16 dereferenceable_or_null(16) i8* @calloc(i64 1, i64 16) #4
-  %4 = bitcast i8* %3 to %struct.MultiArray_T*
-  %5 = getelementptr inbounds %struct.MultiArray_T, %struct.MultiArray_T* %4, i64 0, i32 0
-  store i32 %0, i32* %5, align 16, !tbaa !5
-  %6 = getelementptr inbounds %struct.MultiArray_T, %struct.MultiArray_T* %4, i64 0, i32 1
-  store i8* %1, i8** %6, align 8, !tbaa !11
-  ret %struct.MultiArray_T* %4
+; Called by the checks of jlc --bounds-check
+define void @indexOutOfBounds(i32 %index, i32 %length) cold noreturn {
+entry: %t0 = getelementptr [45 x i8], [45 x i8]* @oob, i32 0, i32 0
+	call i32 (i32, i8*, ...) @dprintf(i32 2, i8* %t0, i32 %index, i32 %length)
+	call void @exit(i32 1)
+	unreachable
+}
+
+%struct.Array_T = type { i32, [0 x i32] }
+
+declare noalias i8* @calloc(i64, i64)
+
+; Zeroed memory for arrays, overridden by lib/arena.ll or lib/gc.c when linked in.
+; The first pointerBytes may hold pointers to other arrays.
+define weak noalias i8* @jlc_alloc(i64 %bytes, i64 %pointerBytes) {
+entry:
+  %p = call i8* @calloc(i64 1, i64 %bytes)
+  ret i8* %p
 }
 
-; Function Attrs: mustprogress nofree nounwind willreturn
-declare noalias noundef align 16 i8* @calloc(i64 noundef, i64 noundef) local_unnamed_addr #1
-
-; Function Attrs: nofree nounwind sspstrong uwtable
-define dso_local noalias %struct.MultiArray_T* @multiArray(i32 %0, i32 %1, i32* nocapture %2) local_unnamed_addr #2 {
-  %4 = load i32, i32* %2, align 4, !tbaa !12
-  %5 = icmp eq i32 %0, 1
-  %6 = sext i32 %4 to i64
-  br i1 %5, label %7, label %10
-
-7:                                                ; preds = %3
-  %8 = sext i32 %1 to i64
-  %9 = tail call noalias align 16 i8* @calloc(i64 %6, i64 %8) #4
-  br label %26
-
-10:                                               ; preds = %3
-  %11 = shl nsw i64 %6, 3
-  %12 = tail call noalias align 16 i8* @malloc(i64 %11) #4
-  %13 = bitcast i8* %12 to i8**
-  %14 = add nsw i32 %0, -1
-  %15 = getelementptr inbounds i32, i32* %2, i64 1
-  %16 = icmp sgt i32 %4, 0
-  br i1 %16, label %17, label %26
-
-17:                                               ; preds = %10
-  %18 = zext i32 %4 to i64
-  br label %19
-
-19:                                               ; preds = %17, %19
-  %20 = phi i64 [ 0, %17 ], [ %24, %19 ]
-  %21 = tail call %struct.MultiArray_T* @multiArray(i32 %14, i32 %1, i32* nonnull %15)
-  %22 = getelementptr inbounds i8*, i8** %13, i64 %20
-  %23 = bitcast i8** %22 to %struct.MultiArray_T**
-  store %struct.MultiArray_T* %21, %struct.MultiArray_T** %23, align 8, !tbaa !13
-  %24 = add nuw nsw i64 %20, 1
-  %25 = icmp eq i64 %24, %18
-  br i1 %25, label %26, label %19, !llvm.loop !14
-
-26:                                               ; preds = %19, %10, %7
-  %27 = phi i8* [ %9, %7 ], [ %12, %10 ], [ %12, %19 ]
-  %28 = tail call noalias align 16 dereferenceable_or_null(16) i8* @calloc(i64 1, i64 16) #4
-  %29 = bitcast i8* %28 to %struct.MultiArray_T*
-  %30 = bitcast i8* %28 to i32*
-  store i32 %4, i32* %30, align 16, !tbaa !5
-  %31 = getelementptr inbounds i8, i8* %28, i64 8
-  %32 = bitcast i8* %31 to i8**
-  store i8* %27, i8** %32, align 8, !tbaa !11
-  ret %struct.MultiArray_T* %29
+; Size of an array of len elements of the given size, rounded up to 8 bytes
+define internal i64 @arraySize(i64 %len, i64 %size) {
+entry:
+  %isWide = icmp ugt i64 %size, 4
+  %offset = select i1 %isWide, i64 %size, i64 4
+  %elementBytes = mul i64 %len, %size
+  %bytes = add i64 %offset, %elementBytes
+  %padded = add i64 %bytes, 7
+  %rounded = and i64 %padded, -8
+  ret i64 %rounded
 }
 
-; Function Attrs: inaccessiblememonly mustprogress nofree nounwind willreturn
-declare noalias noundef align 16 i8* @malloc(i64 noundef) local_unnamed_addr #3
-
-attributes #0 = { mustprogress nofree nounwind sspstrong uwtable willreturn "frame-pointer"="none" "min-legal-vector-width"="0" "no-trapping-math"="true" "stack-protector-buffer-size"="8" "target-cpu"="x86-64" "target-features"="+cx8,+fxsr,+mmx,+sse,+sse2,+x87" "tune-cpu"="generic" }
-attributes #1 = { mustprogress nofree nounwind willreturn "frame-pointer"="none" "no-trapping-math"="true" "stack-protector-buffer-size"="8" "target-cpu"="x86-64" "target-features"="+cx8,+fxsr,+mmx,+sse,+sse2,+x87" "tune-cpu"="generic" }
-attributes #2 = { nofree nounwind sspstrong uwtable "frame-pointer"="none" "min-legal-vector-width"="0" "no-trapping-math"="true" "stack-protector-buffer-size"="8" "target-cpu"="x86-64" "target-features"="+cx8,+fxsr,+mmx,+sse,+sse2,+x87" "tune-cpu"="generic" }
-attributes #3 = { inaccessiblememonly mustprogress nofree nounwind willreturn "frame-pointer"="none" "no-trapping-math"="true" "stack-protector-buffer-size"="8" "target-cpu"="x86-64" "target-features"="+cx8,+fxsr,+mmx,+sse,+sse2,+x87" "tune-cpu"="generic" }
-attributes #4 = { nounwind }
-
-!llvm.module.flags = !{!0, !1, !2, !3}
-!llvm.ident = !{!4}
-
-!0 = !{i32 1, !"wchar_size", i32 4}
-!1 = !{i32 7, !"PIC Level", i32 2}
-!2 = !{i32 7, !"PIE Level", i32 2}
-!3 = !{i32 7, !"uwtable", i32 1}
-!4 = !{!"clang version 13.0.1"}
-!5 = !{!6, !7, i64 0}
-!6 = !{!"MultiArray_T", !7, i64 0, !10, i64 8}
-!7 = !{!"int", !8, i64 0}
-!8 = !{!"omnipotent char", !9, i64 0}
-!9 = !{!"Simple C/C++ TBAA"}
-!10 = !{!"any pointer", !8, i64 0}
-!11 = !{!6, !10, i64 8}
-!12 = !{!7, !7, i64 0}
-!13 = !{!10, !10, i64 0}
-!14 = distinct !{!14, !15}
-!15 = !{!"llvm.loop.mustprogress"}
+; Allocates an n-dimensional array as one zeroed block, see lib/multiarray.c
+define %struct.Array_T* @multiArray(i32 %n, i32 %size, i32* nocapture readonly %dimList) {
+entry:
+  %last = add i32 %n, -1
+  %size64 = sext i32 %size to i64
+  br label %sizeLoop
+
+sizeLoop:
+  %k = phi i32 [ 0, %entry ], [ %k.next, %sizeLoop ]
+  %count = phi i64 [ 1, %entry ], [ %count.next, %sizeLoop ]
+  %bytes = phi i64 [ 0, %entry ], [ %bytes.next, %sizeLoop ]
+  %dimPtr = getelementptr inbounds i32, i32* %dimList, i32 %k
+  %dim = load i32, i32* %dimPtr
+  %dim64 = sext i32 %dim to i64
+  %isLastDim = icmp eq i32 %k, %last
+  %rowSize = select i1 %isLastDim, i64 %size64, i64 8
+  %arrayBytes = call i64 @arraySize(i64 %dim64, i64 %rowSize)
+  %levelBytes = mul i64 %count, %arrayBytes
+  %bytes.next = add i64 %bytes, %levelBytes
+  %count.next = mul i64 %count, %dim64
+  %k.next = add i32 %k, 1
+  %moreDims = icmp slt i32 %k.next, %n
+  br i1 %moreDims, label %sizeLoop, label %allocate
+
+; All but the last level are rows, which point to other arrays
+allocate:
+  %block = call i8* @jlc_alloc(i64 %bytes.next, i64 %bytes)
+  br label %level
+
+; The arrays of level lk start at levelPtr, the ones of the next level at next
+level:
+  %lk = phi i32 [ 0, %allocate ], [ %lk.next, %levelEnd ]
+  %levelPtr = phi i8* [ %block, %allocate ], [ %next, %levelEnd ]
+  %rows = phi i64 [ 1, %allocate ], [ %rows.next, %levelEnd ]
+  %lenPtr = getelementptr inbounds i32, i32* %dimList, i32 %lk
+  %len = load i32, i32* %lenPtr
+  %len64 = sext i32 %len to i64
+  %isLast = icmp eq i32 %lk, %last
+  %levelRowSize = select i1 %isLast, i64 %size64, i64 8
+  %levelSize = call i64 @arraySize(i64 %len64, i64 %levelRowSize)
+  %levelSpan = mul i64 %rows, %levelSize
+  %next = getelementptr inbounds i8, i8* %levelPtr, i64 %levelSpan
+  br i1 %isLast, label %nextSizeDone, label %nextSize
+
+nextSize:
+  %lk1 = add i32 %lk, 1
+  %nextLenPtr = getelementptr inbounds i32, i32* %dimList, i32 %lk1
+  %nextLen = load i32, i32* %nextLenPtr
+  %nextLen64 = sext i32 %nextLen to i64
+  %nextIsLast = icmp eq i32 %lk1, %last
+  %nextRowSize = select i1 %nextIsLast, i64 %size64, i64 8
+  %nextArraySize = call i64 @arraySize(i64 %nextLen64, i64 %nextRowSize)
+  br label %nextSizeDone
+
+nextSizeDone:
+  %childSize = phi i64 [ 0, %level ], [ %nextArraySize, %nextSize ]
+  br label %rowTest
+
+rowTest:
+  %j = phi i64 [ 0, %nextSizeDone ], [ %j.next, %rowDone ]
+  %hasRow = icmp slt i64 %j, %rows
+  br i1 %hasRow, label %row, label %levelEnd
+
+row:
+  %rowOffset = mul i64 %j, %levelSize
+  %rowPtr = getelementptr inbounds i8, i8* %levelPtr, i64 %rowOffset
+  %lengthField = bitcast i8* %rowPtr to i32*
+  store i32 %len, i32* %lengthField
+  %firstChild = mul i64 %j, %len64
+  %j.next = add i64 %j, 1
+  br i1 %isLast, label %rowDone, label %pointerTest
+
+pointerTest:
+  %i = phi i64 [ 0, %row ], [ %i.next, %pointer ]
+  %hasPointer = icmp slt i64 %i, %len64
+  br i1 %hasPointer, label %pointer, label %rowDone
+
+pointer:
+  %child = add i64 %firstChild, %i
+  %childOffset = mul i64 %child, %childSize
+  %childPtr = getelementptr inbounds i8, i8* %next, i64 %childOffset
+  %slotsI8 = getelementptr inbounds i8, i8* %rowPtr, i64 8
+  %slots = bitcast i8* %slotsI8 to i8**
+  %slot = getelementptr inbounds i8*, i8** %slots, i64 %i
+  store i8* %childPtr, i8** %slot
+  %i.next = add i64 %i, 1
+  br label %pointerTest
+
+rowDone:
+  br label %rowTest
+
+levelEnd:
+  %lk.next = add i32 %lk, 1
+  %rows.next = mul i64 %rows, %len64
+  %moreLevels = icmp slt i32 %lk.next, %n
+  br i1 %moreLevels, label %level, label %done
+
+done:
+  %array = bitcast i8* %block to %struct.Array_T*
+  ret %struct.Array_T* %array
+}
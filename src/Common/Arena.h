@@ -0,0 +1,119 @@
+#pragma once
+
+#include "NodeKind.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace jlc {
+
+// Places a node of type T in memory of nodeSize<T>, after its kind tag (see NodeKind.h)
+template <class T> inline constexpr std::size_t kindTagSize = alignof(T);
+template <class T> inline constexpr std::size_t nodeSize = kindTagSize<T> + sizeof(T);
+
+template <class T, class... Args> T* constructNode(void* memory, Args&&... args) {
+    char* p = static_cast<char*>(memory) + kindTagSize<T>;
+    reinterpret_cast<NodeKind*>(p)[-1] = nodeKindOf<T>;
+    return new (p) T(std::forward<Args>(args)...);
+}
+
+// True for the bnfc list nodes (ListStmt, ListExpr, ...), which derive from std::vector
+template <class T, class = void> struct IsVectorNode : std::false_type {};
+template <class T>
+struct IsVectorNode<T, std::void_t<typename T::value_type>>
+    : std::is_base_of<std::vector<typename T::value_type>, T> {};
+
+// Bump-pointer allocator owning the AST and type nodes, which are released in one
+// shot when the arena is destroyed. The node destructors are never run, since
+// bnfc's destructors delete the children themselves. Only the element buffers of
+// the list nodes are freed.
+//
+// A node made by jlc::make must never be deleted, by delete or by the destructor of
+// its parent: it points past its kind tag, into memory that operator new didn't
+// return. Nor may it be clone()d, since bnfc's clone copies with new and drops the
+// kind tag.
+class Arena {
+  public:
+    Arena() = default;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() {
+        for (auto [destroy, node] : cleanups_)
+            destroy(node);
+        for (char* block : blocks_)
+            std::free(block);
+    }
+
+    void* allocate(std::size_t size, std::size_t align) {
+        std::size_t padding = -reinterpret_cast<std::uintptr_t>(next_) & (align - 1);
+        if (next_ == nullptr || size + padding > std::size_t(end_ - next_)) {
+            // Big nodes get their own block, so that the current one isn't wasted
+            if (size > BlockSize / 4)
+                return newBlock(size);
+            next_ = newBlock(BlockSize);
+            end_ = next_ + BlockSize;
+            padding = 0;
+        }
+        char* p = next_ + padding;
+        next_ = p + size;
+        return p;
+    }
+
+    template <class T, class... Args> T* make(Args&&... args) {
+        static_assert(alignof(T) <= alignof(std::max_align_t));
+        T* node = constructNode<T>(allocate(nodeSize<T>, alignof(T)),
+                                   std::forward<Args>(args)...);
+        if constexpr (IsVectorNode<T>::value) {
+            using Vector = std::vector<typename T::value_type>;
+            cleanups_.emplace_back(
+                [](void* p) { static_cast<Vector*>(static_cast<T*>(p))->~Vector(); },
+                node);
+        }
+        return node;
+    }
+
+    // The arena used by jlc::make on this thread
+    static Arena* current() { return current_; }
+
+    // Makes an arena current for as long as the scope lives, e.g. during parsing
+    class Scope {
+        Arena* previous_;
+
+      public:
+        explicit Scope(Arena& arena) : previous_(current_) { current_ = &arena; }
+        ~Scope() { current_ = previous_; }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+  private:
+    static constexpr std::size_t BlockSize = 64 * 1024;
+
+    char* newBlock(std::size_t size) {
+        char* block = static_cast<char*>(std::malloc(size));
+        if (block == nullptr)
+            throw std::bad_alloc();
+        blocks_.push_back(block);
+        return block;
+    }
+
+    char* next_ = nullptr;
+    char* end_ = nullptr;
+    std::vector<char*> blocks_;
+    std::vector<std::pair<void (*)(void*), void*>> cleanups_;
+    inline static thread_local Arena* current_ = nullptr;
+};
+
+// Allocates a node in the current arena, or on the heap (never freed) when there is none.
+template <class T, class... Args> T* make(Args&&... args) {
+    if (Arena* arena = Arena::current())
+        return arena->make<T>(std::forward<Args>(args)...);
+    return constructNode<T>(::operator new(nodeSize<T>), std::forward<Args>(args)...);
+}
+
+} // namespace jlc
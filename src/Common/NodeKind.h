@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+
+// Kind tags of the AST nodes, so that code can switch on the kind of a node instead
+// of running a visitor or a dynamic_cast to find out what it is. The tag is written
+// in front of the node when it is allocated by jlc::make (see Arena.h), which is how
+// all nodes are created.
+
+#define JLC_NODE_KINDS(X)                                                                \
+    X(Program) X(FnDef) X(Argument) X(Block)                                             \
+    X(Empty) X(BStmt) X(Decl) X(Ass) X(Incr) X(Decr) X(Ret) X(VRet) X(Cond) X(CondElse)  \
+    X(While) X(For) X(SExp) X(NoInit) X(Init) X(Dimension)                               \
+    X(Int) X(Doub) X(Bool) X(Void) X(Arr) X(StringLit) X(Fun)                            \
+    X(ExpDimen) X(EIndex) X(EVar) X(EApp) X(EArrNew) X(EArrLen) X(ELitInt) X(ELitDoub)   \
+    X(ELitTrue) X(ELitFalse) X(EString) X(Neg) X(Not) X(EMul) X(EAdd) X(ERel) X(EAnd)    \
+    X(EOr) X(ETyped)                                                                     \
+    X(Plus) X(Minus) X(Times) X(Div) X(Mod) X(LTH) X(LE) X(GTH) X(GE) X(EQU) X(NE)       \
+    X(ListTopDef) X(ListArg) X(ListStmt) X(ListItem) X(ListType) X(ListDim) X(ListExpr)  \
+    X(ListExpDim)
+
+namespace bnfc {
+class Visitable;
+#define JLC_DECLARE_NODE(Name) class Name;
+JLC_NODE_KINDS(JLC_DECLARE_NODE)
+#undef JLC_DECLARE_NODE
+} // namespace bnfc
+
+namespace jlc {
+
+enum class NodeKind : std::uint8_t {
+    Unknown,
+#define JLC_NODE_KIND(Name) Name,
+    JLC_NODE_KINDS(JLC_NODE_KIND)
+#undef JLC_NODE_KIND
+};
+
+template <class T> inline constexpr NodeKind nodeKindOf = NodeKind::Unknown;
+#define JLC_NODE_KIND_OF(Name)                                                           \
+    template <> inline constexpr NodeKind nodeKindOf<bnfc::Name> = NodeKind::Name;
+JLC_NODE_KINDS(JLC_NODE_KIND_OF)
+#undef JLC_NODE_KIND_OF
+
+// The tag sits in the byte right before the node
+inline NodeKind kindOf(const bnfc::Visitable* p) {
+    return reinterpret_cast<const NodeKind*>(p)[-1];
+}
+
+} // namespace jlc
@@ -0,0 +1,158 @@
+#include "Options.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace jlc {
+
+// The most threads -j starts
+constexpr unsigned long maxJobs = 1024;
+
+// Returns the value of an option given either as "--opt=value" or "--opt value"
+static std::string optionValue(const std::string& arg, const std::string& name, int& i,
+                               int argc, char** argv) {
+    if (arg.size() > name.size() && arg[name.size()] == '=')
+        return arg.substr(name.size() + 1);
+    if (i + 1 >= argc)
+        throw std::runtime_error("ERROR: Missing value for option '" + name + "'");
+    return argv[++i];
+}
+
+static bool hasName(const std::string& arg, const std::string& name) {
+    return arg.compare(0, name.size(), name) == 0 &&
+           (arg.size() == name.size() || arg[name.size()] == '=');
+}
+
+// The runtime objects are expected in lib/ next to the jlc executable (see 'make runtime')
+static std::string libFile(const char* argv0, const char* name) {
+    std::string exe = llvm::sys::fs::getMainExecutable(argv0, (void*)&parseOptions);
+    llvm::SmallString<128> path(llvm::sys::path::parent_path(exe));
+    llvm::sys::path::append(path, "lib", name);
+    return path.str().str();
+}
+
+std::vector<std::string> runtimeFiles(const Options& options) {
+    std::vector<std::string> files = options.objectFiles;
+    files.push_back(options.runtimeFile);
+    if (!options.arenaFile.empty())
+        files.push_back(options.arenaFile);
+    if (!options.gcFile.empty())
+        files.push_back(options.gcFile);
+    return files;
+}
+
+std::string outputFileFor(const std::string& inputFile, const char* extension) {
+    llvm::SmallString<128> path(llvm::sys::path::filename(inputFile));
+    llvm::sys::path::replace_extension(path, extension);
+    return path.str().str();
+}
+
+Options parseOptions(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "-O") {
+            options.optLevel = 2;
+        } else if (arg.size() == 3 && arg.compare(0, 2, "-O") == 0 && arg[2] >= '0' &&
+                   arg[2] <= '3') {
+            options.optLevel = arg[2] - '0';
+        } else if (arg == "-c") {
+            options.compileOnly = true;
+        } else if (arg.compare(0, 2, "-j") == 0) {
+            // -j N or -jN, like make
+            char* end = nullptr;
+            std::string jobs =
+                arg.size() > 2 ? arg.substr(2) : optionValue(arg, "-j", i, argc, argv);
+            // strtoul would take "-1" as ULONG_MAX, hence the check for a digit first
+            unsigned long count = std::strtoul(jobs.c_str(), &end, 10);
+            if (jobs.empty() || !std::isdigit((unsigned char)jobs[0]) || *end != '\0' ||
+                count == 0 || count > maxJobs)
+                throw std::runtime_error("ERROR: Invalid number of jobs '" + jobs +
+                                         "' for -j");
+            options.jobs = count;
+        } else if (arg == "--emit-bc") {
+            options.emitBitcode = true;
+        } else if (arg == "--run") {
+            options.run = true;
+        } else if (hasName(arg, "--tiered")) {
+            // Implies --run, optionally with the number of calls before tiering up
+            options.run = true;
+            options.tierThreshold = 1000;
+            if (arg != "--tiered") {
+                // The calls are counted in an i32 of the program
+                char* end = nullptr;
+                std::string calls = arg.substr(9);
+                unsigned long threshold = std::strtoul(calls.c_str(), &end, 10);
+                if (calls.empty() || *end != '\0' || threshold == 0 ||
+                    threshold > INT32_MAX)
+                    throw std::runtime_error("ERROR: Invalid call count '" + calls +
+                                             "' for --tiered");
+                options.tierThreshold = threshold;
+            }
+        } else if (hasName(arg, "--time-report")) {
+            options.timeReport = true;
+            if (arg != "--time-report")
+                options.timeReportFile = arg.substr(arg.find('=') + 1);
+        } else if (hasName(arg, "--trace")) {
+            options.traceFile = optionValue(arg, "--trace", i, argc, argv);
+        } else if (arg == "-o") {
+            options.outputFile = optionValue(arg, "-o", i, argc, argv);
+        } else if (arg == "--arena") {
+            options.arenaFile = libFile(argv[0], "arena.o");
+        } else if (arg == "--emit-interface") {
+            options.emitInterface = true;
+        } else if (arg == "--bounds-check") {
+            options.boundsCheck = true;
+        } else if (arg == "--gc") {
+            options.gcFile = libFile(argv[0], "gc.o");
+        } else if (hasName(arg, "--runtime")) {
+            options.runtimeFile = optionValue(arg, "--runtime", i, argc, argv);
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            throw std::runtime_error("ERROR: Unknown option '" + arg + "'");
+        } else if (llvm::sys::path::extension(arg) == ".jli") {
+            options.interfaceFiles.push_back(arg);
+        } else if (llvm::sys::path::extension(arg) == ".o") {
+            options.objectFiles.push_back(arg);
+        } else {
+            options.inputFiles.push_back(arg);
+        }
+    }
+
+    if (options.run && (options.compileOnly || options.emitBitcode ||
+                        !options.outputFile.empty()))
+        throw std::runtime_error("ERROR: --run can't be combined with -c, -o or --emit-bc");
+
+    if (!options.arenaFile.empty() && !options.gcFile.empty())
+        throw std::runtime_error("ERROR: --arena can't be combined with --gc");
+
+    // Several sources give a module each. They are written next to each other with -c,
+    // or linked together with -o. --emit-interface alone only writes the interfaces.
+    bool linking = !options.outputFile.empty() && !options.compileOnly &&
+                   !options.emitBitcode;
+    if (options.inputFiles.size() > 1) {
+        if (options.compileOnly && !options.outputFile.empty())
+            throw std::runtime_error("ERROR: -o can't be combined with -c for several "
+                                     "input files");
+        if (!options.compileOnly && !linking &&
+            !(options.emitInterface && !options.run && !options.emitBitcode))
+            throw std::runtime_error("ERROR: Several input files need -c or -o");
+    }
+    if (!options.objectFiles.empty() && !linking && !options.run)
+        throw std::runtime_error("ERROR: Object files can only be linked with -o or run");
+
+    if (options.compileOnly && options.outputFile.empty() &&
+        options.inputFiles.size() <= 1)
+        options.outputFile = outputFileFor(
+            options.inputFiles.empty() ? "a" : options.inputFiles[0],
+            options.emitBitcode ? "bc" : "o");
+    if (options.runtimeFile.empty())
+        options.runtimeFile = libFile(argv[0], "runtime.o");
+
+    return options;
+}
+
+} // namespace jlc
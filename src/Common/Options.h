@@ -0,0 +1,41 @@
+#pragma once
+#include <string>
+#include <vector>
+
+namespace jlc {
+
+// Command line options of jlc
+struct Options {
+    // Each .jl source is a module of its own, read from std in if there are none
+    std::vector<std::string> inputFiles;
+    std::vector<std::string> interfaceFiles; // .jli, of separately compiled modules
+    std::vector<std::string> objectFiles;    // .o, separately compiled modules
+    bool emitInterface = false;              // --emit-interface, file.jli per source
+    unsigned optLevel = 0;           // -O0, -O1, -O2 or -O3
+    unsigned jobs = 1;               // -j N, build the functions of a source on N threads
+    bool compileOnly = false;        // -c, emit an object file instead of IR
+    bool emitBitcode = false;        // --emit-bc, emit LLVM bitcode instead of text IR
+    bool run = false;                // --run, JIT-compile and run the program in-process
+    unsigned tierThreshold = 0;      // --tiered[=calls], recompile hot functions at -O3
+    bool timeReport = false;         // --time-report[=file], time the compiler phases
+    std::string timeReportFile;      // JSON time report, printed as tables if not set
+    std::string traceFile;           // --trace, Chrome trace events of phases and functions
+    std::string outputFile;          // -o, object file, bitcode or linked executable
+    std::string runtimeFile;         // --runtime, prebuilt runtime object to link/JIT with
+    std::string arenaFile;           // --arena, arena allocator object replacing calloc
+    std::string gcFile;              // --gc, garbage collector object replacing calloc
+    bool boundsCheck = false;        // --bounds-check, exit on out of bounds indexing
+};
+
+// The objects to link (or JIT) the program with, the separately compiled modules
+// followed by the runtime
+std::vector<std::string> runtimeFiles(const Options& options);
+
+// Like cc: 'jlc -c dir/file.jl' writes file.o in the current directory, or file.bc
+// with --emit-bc
+std::string outputFileFor(const std::string& inputFile, const char* extension);
+
+// Parses the command line, throws std::runtime_error on an invalid argument.
+Options parseOptions(int argc, char** argv);
+
+} // namespace jlc
@@ -0,0 +1,51 @@
+#pragma once
+#include "llvm/Support/TimeProfiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace jlc {
+
+// Events shorter than 100us are only counted in the per-name totals of the trace
+constexpr unsigned traceGranularity = 100;
+
+// Calls fn(0) to fn(n - 1) on up to jobs threads, which take the next index when they
+// are done with one. Rethrows the first exception once all the threads have finished.
+// With --trace each thread records its events, which end up in the same trace.
+template <typename Fn> void runInParallel(unsigned jobs, std::size_t n, Fn fn) {
+    std::size_t threadCount = std::min<std::size_t>(jobs, n);
+    if (threadCount <= 1) {
+        for (std::size_t i = 0; i < n; i++)
+            fn(i);
+        return;
+    }
+
+    bool trace = llvm::timeTraceProfilerEnabled();
+    std::atomic<std::size_t> next{0};
+    std::vector<std::exception_ptr> errors(n);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < threadCount; t++)
+        threads.emplace_back([&] {
+            if (trace)
+                llvm::timeTraceProfilerInitialize(traceGranularity, "jlc");
+            for (std::size_t i; (i = next++) < n;) {
+                try {
+                    fn(i);
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            }
+            if (trace)
+                llvm::timeTraceProfilerFinishThread();
+        });
+    for (std::thread& thread : threads)
+        thread.join();
+    for (std::exception_ptr& error : errors)
+        if (error)
+            std::rethrow_exception(error);
+}
+
+} // namespace jlc
@@ -0,0 +1,60 @@
+#include "PhaseTimers.h"
+
+namespace jlc {
+
+using namespace llvm;
+
+PhaseTimers::~PhaseTimers() {
+    // Otherwise the groups print the timers that have run when they are destroyed
+    for (auto& timer : timers_)
+        timer->clear();
+}
+
+PhaseTimers::Scope::Scope(PhaseTimers& timers, StringRef name, StringRef description)
+    : timers_(timers), trace_(description) {
+    if (!timers_.enabled_)
+        return;
+    // A phase's timer lives in the group of the phase it runs in
+    TimerGroup& group =
+        timers_.running_.empty()
+            ? timers_.getGroup("jlc", "Compile phases")
+            : timers_.getGroup(timers_.running_.back().first,
+                               timers_.running_.back().second);
+    timer_ = timers_.timers_.emplace_back(std::make_unique<Timer>(name, description, group))
+                 .get();
+    timers_.running_.emplace_back(name.str(), description.str());
+    timer_->startTimer();
+}
+
+PhaseTimers::Scope::~Scope() {
+    if (!timer_)
+        return;
+    timer_->stopTimer();
+    timers_.running_.pop_back();
+}
+
+TimerGroup& PhaseTimers::getGroup(const std::string& name,
+                                  const std::string& description) {
+    for (auto& [groupName, group] : groups_)
+        if (groupName == name)
+            return *group;
+    return *groups_.emplace_back(name, std::make_unique<TimerGroup>(name, description))
+                .second;
+}
+
+void PhaseTimers::print(raw_ostream& os) {
+    for (auto& [_, group] : groups_)
+        group->print(os, true);
+}
+
+void PhaseTimers::printJSON(raw_ostream& os) {
+    os << "{";
+    const char* delim = "\n";
+    for (auto& [_, group] : groups_)
+        delim = group->printJSONValues(os, delim);
+    os << "\n}\n";
+    for (auto& timer : timers_)
+        timer->clear();
+}
+
+} // namespace jlc
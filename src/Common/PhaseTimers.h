@@ -0,0 +1,49 @@
+#pragma once
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace jlc {
+
+// Wall and CPU time of the compiler phases, for --time-report. Phases nest, and the
+// sub-phases of each phase get their own llvm::TimerGroup: "jlc" times "frontend" and
+// "backend", "frontend" times "parse" and "typecheck", and so on. When disabled the
+// scopes measure nothing. The scopes are also recorded as --trace events.
+class PhaseTimers {
+  public:
+    explicit PhaseTimers(bool enabled) : enabled_(enabled) {}
+    ~PhaseTimers();
+
+    // Times a phase for as long as it lives
+    class Scope {
+      public:
+        Scope(PhaseTimers& timers, llvm::StringRef name, llvm::StringRef description);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+      private:
+        PhaseTimers& timers_;
+        llvm::Timer* timer_ = nullptr;
+        llvm::TimeTraceScope trace_;
+    };
+
+    // One table per group, outer phases first
+    void print(llvm::raw_ostream& os);
+    // A single JSON object with "time.<group>.<phase>.<wall|user|sys>" keys, in seconds
+    void printJSON(llvm::raw_ostream& os);
+
+  private:
+    llvm::TimerGroup& getGroup(const std::string& name, const std::string& description);
+
+    bool enabled_;
+    std::vector<std::pair<std::string, std::string>> running_; // Name, description
+    std::vector<std::pair<std::string, std::unique_ptr<llvm::TimerGroup>>> groups_;
+    std::vector<std::unique_ptr<llvm::Timer>> timers_;
+};
+
+} // namespace jlc
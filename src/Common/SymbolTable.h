@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace jlc {
+
+// Dense id of an interned identifier
+using Symbol = std::uint32_t;
+
+// Interns identifiers, giving each distinct name a dense Symbol starting from 0
+class SymbolTable {
+    std::unordered_map<std::string, Symbol> ids_;
+
+  public:
+    Symbol intern(const std::string& name) {
+        auto found = ids_.find(name);
+        if (found != ids_.end())
+            return found->second;
+        return ids_.emplace(name, Symbol(ids_.size())).first->second;
+    }
+
+    std::size_t size() const { return ids_.size(); }
+};
+
+// Nested scopes of bindings from Symbol to T, as one flat table indexed by symbol.
+// Each symbol's slot holds its innermost binding, and the bindings it shadows are
+// kept in an undo log that exitScope() rolls back. Lookups are a single index, and
+// entering or leaving scopes doesn't allocate once the vectors have grown.
+template <class T> class ScopeTable {
+    struct Binding {
+        T value{};
+        std::size_t depth = 0; // 0 if unbound, otherwise the scope depth it was added in
+    };
+
+    std::vector<Binding> bindings_; // Indexed by Symbol
+    std::vector<std::pair<Symbol, Binding>> undo_;
+    std::vector<std::size_t> scopeStarts_; // Size of undo_ when each scope was entered
+
+  public:
+    void enterScope() { scopeStarts_.push_back(undo_.size()); }
+
+    void exitScope() {
+        for (std::size_t start = scopeStarts_.back(); undo_.size() > start;
+             undo_.pop_back())
+            bindings_[undo_.back().first] = undo_.back().second;
+        scopeStarts_.pop_back();
+    }
+
+    // Binds the symbol in the innermost scope, returns false if it already is bound there
+    bool add(Symbol symbol, T value) {
+        if (symbol >= bindings_.size())
+            bindings_.resize(symbol + 1);
+        Binding& binding = bindings_[symbol];
+        if (binding.depth == scopeStarts_.size())
+            return false;
+        undo_.emplace_back(symbol, binding);
+        binding = {std::move(value), scopeStarts_.size()};
+        return true;
+    }
+
+    // The innermost binding of the symbol, or nullptr
+    const T* find(Symbol symbol) const {
+        if (symbol >= bindings_.size() || bindings_[symbol].depth == 0)
+            return nullptr;
+        return &bindings_[symbol].value;
+    }
+};
+
+} // namespace jlc
@@ -0,0 +1,140 @@
+#include "Frontend/CallGraph.h"
+#include "src/Common/NodeKind.h"
+
+#include <algorithm>
+
+namespace jlc::typechecker {
+
+namespace {
+
+// Collects the names of the functions called by the statements of a function body
+class CallCollector {
+    std::vector<std::string>& calls_;
+
+  public:
+    explicit CallCollector(std::vector<std::string>& calls) : calls_(calls) {}
+
+    void block(Blk* p) {
+        for (Stmt* stmt : *static_cast<Block*>(p)->liststmt_)
+            this->stmt(stmt);
+    }
+
+    void stmt(Stmt* p) {
+        switch (kindOf(p)) {
+        case NodeKind::BStmt: block(static_cast<BStmt*>(p)->blk_); break;
+        case NodeKind::Decl:
+            for (Item* item : *static_cast<Decl*>(p)->listitem_)
+                if (kindOf(item) == NodeKind::Init)
+                    expr(static_cast<Init*>(item)->expr_);
+            break;
+        case NodeKind::Ass:
+            expr(static_cast<Ass*>(p)->expr_1);
+            expr(static_cast<Ass*>(p)->expr_2);
+            break;
+        case NodeKind::Ret: expr(static_cast<Ret*>(p)->expr_); break;
+        case NodeKind::SExp: expr(static_cast<SExp*>(p)->expr_); break;
+        case NodeKind::Cond:
+            expr(static_cast<Cond*>(p)->expr_);
+            stmt(static_cast<Cond*>(p)->stmt_);
+            break;
+        case NodeKind::CondElse:
+            expr(static_cast<CondElse*>(p)->expr_);
+            stmt(static_cast<CondElse*>(p)->stmt_1);
+            stmt(static_cast<CondElse*>(p)->stmt_2);
+            break;
+        case NodeKind::While:
+            expr(static_cast<While*>(p)->expr_);
+            stmt(static_cast<While*>(p)->stmt_);
+            break;
+        case NodeKind::For:
+            expr(static_cast<For*>(p)->expr_);
+            stmt(static_cast<For*>(p)->stmt_);
+            break;
+        default: break; // Empty, Incr, Decr, VRet
+        }
+    }
+
+    void expr(Expr* p) {
+        switch (kindOf(p)) {
+        case NodeKind::ETyped: expr(static_cast<ETyped*>(p)->expr_); break;
+        case NodeKind::EApp: {
+            auto app = static_cast<EApp*>(p);
+            calls_.push_back(app->ident_);
+            for (Expr* arg : *app->listexpr_)
+                expr(arg);
+            break;
+        }
+        case NodeKind::EIndex: {
+            auto index = static_cast<EIndex*>(p);
+            expr(index->expr_);
+            expr(static_cast<ExpDimen*>(index->expdim_)->expr_);
+            break;
+        }
+        case NodeKind::EArrNew:
+            for (ExpDim* dim : *static_cast<EArrNew*>(p)->listexpdim_)
+                expr(static_cast<ExpDimen*>(dim)->expr_);
+            break;
+        case NodeKind::EArrLen: expr(static_cast<EArrLen*>(p)->expr_); break;
+        case NodeKind::Neg: expr(static_cast<Neg*>(p)->expr_); break;
+        case NodeKind::Not: expr(static_cast<Not*>(p)->expr_); break;
+        case NodeKind::EMul:
+            expr(static_cast<EMul*>(p)->expr_1);
+            expr(static_cast<EMul*>(p)->expr_2);
+            break;
+        case NodeKind::EAdd:
+            expr(static_cast<EAdd*>(p)->expr_1);
+            expr(static_cast<EAdd*>(p)->expr_2);
+            break;
+        case NodeKind::ERel:
+            expr(static_cast<ERel*>(p)->expr_1);
+            expr(static_cast<ERel*>(p)->expr_2);
+            break;
+        case NodeKind::EAnd:
+            expr(static_cast<EAnd*>(p)->expr_1);
+            expr(static_cast<EAnd*>(p)->expr_2);
+            break;
+        case NodeKind::EOr:
+            expr(static_cast<EOr*>(p)->expr_1);
+            expr(static_cast<EOr*>(p)->expr_2);
+            break;
+        default: break; // Literals, EVar, EString
+        }
+    }
+};
+
+} // namespace
+
+CallGraph::CallGraph(Prog* p) {
+    for (TopDef* def : *static_cast<Program*>(p)->listtopdef_) {
+        auto fn = static_cast<FnDef*>(def); // The only kind of TopDef
+        CallCollector(callees_[fn->ident_]).block(fn->blk_);
+    }
+}
+
+std::unordered_set<std::string> CallGraph::reachableFrom(const std::string& fn) const {
+    std::unordered_set<std::string> reached{fn};
+    std::vector<std::string> worklist{fn};
+    while (!worklist.empty()) {
+        std::string caller = std::move(worklist.back());
+        worklist.pop_back();
+        auto it = callees_.find(caller);
+        if (it == callees_.end()) // The predefined functions (printInt, ...)
+            continue;
+        for (const std::string& callee : it->second)
+            if (reached.insert(callee).second)
+                worklist.push_back(callee);
+    }
+    return reached;
+}
+
+void removeDeadFunctions(Prog* p) {
+    std::unordered_set<std::string> live = CallGraph(p).reachableFrom("main");
+    ListTopDef& defs = *static_cast<Program*>(p)->listtopdef_;
+    defs.erase(std::remove_if(defs.begin(), defs.end(),
+                              [&](TopDef* def) {
+                                  return !live.count(static_cast<FnDef*>(def)->ident_);
+                              }),
+               defs.end());
+}
+
+} // namespace jlc::typechecker
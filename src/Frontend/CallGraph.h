@@ -0,0 +1,28 @@
+#pragma once
+#include "bnfc/Absyn.H"
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace jlc::typechecker {
+using namespace bnfc;
+
+// The functions that each function of a program calls, from the EApp nodes of its
+// typed AST. Calls that constant folding removed, e.g. in if (false), don't count.
+class CallGraph {
+    std::unordered_map<std::string, std::vector<std::string>> callees_;
+
+  public:
+    explicit CallGraph(Prog* p);
+
+    // The functions that may run when calling fn, fn included
+    std::unordered_set<std::string> reachableFrom(const std::string& fn) const;
+};
+
+// Removes the functions that main never calls, directly or not, so that they are
+// neither built nor optimized
+void removeDeadFunctions(Prog* p);
+
+} // namespace jlc::typechecker
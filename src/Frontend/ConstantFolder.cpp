@@ -0,0 +1,285 @@
+#include "Frontend/ConstantFolder.h"
+#include "llvm/Support/TimeProfiler.h"
+
+#include <climits>
+#include <cstdint>
+
+namespace jlc::typechecker {
+
+namespace {
+
+// The expression inside the ETyped of a subexpression
+Expr* unwrap(Expr* p) {
+    return kindOf(p) == NodeKind::ETyped ? static_cast<ETyped*>(p)->expr_ : p;
+}
+
+// The literal a subexpression was folded to, or null
+Expr* literal(Expr* p) {
+    p = unwrap(p);
+    switch (kindOf(p)) {
+    case NodeKind::ELitInt:
+    case NodeKind::ELitDoub:
+    case NodeKind::ELitTrue:
+    case NodeKind::ELitFalse: return p;
+    default: return nullptr;
+    }
+}
+
+Integer intValue(Expr* lit) { return static_cast<ELitInt*>(lit)->integer_; }
+Double doubleValue(Expr* lit) { return static_cast<ELitDoub*>(lit)->double_; }
+bool boolValue(Expr* lit) { return kindOf(lit) == NodeKind::ELitTrue; }
+
+Expr* boolLiteral(bool value) {
+    if (value)
+        return make<ELitTrue>();
+    return make<ELitFalse>();
+}
+
+// Two's complement, like the i32 arithmetic of the generated code
+Integer wrap(std::uint32_t value) { return static_cast<Integer>(value); }
+
+// A statement that isn't run can only be dropped if it doesn't declare anything,
+// since the branches of an if-statement without braces share its scope.
+bool canDrop(Stmt* p) { return kindOf(p) != NodeKind::Decl; }
+
+} // namespace
+
+void ConstantFolder::run(Prog* p) {
+    Arena::Scope scope(arena_);
+    for (TopDef* def : *static_cast<Program*>(p)->listtopdef_) {
+        auto fn = static_cast<FnDef*>(def); // The only kind of TopDef
+        llvm::TimeTraceScope trace("Fold function", fn->ident_);
+        foldBlock(fn->blk_);
+    }
+}
+
+void ConstantFolder::foldBlock(Blk* p) {
+    for (Stmt*& stmt : *static_cast<Block*>(p)->liststmt_)
+        stmt = foldStmt(stmt);
+}
+
+// Returns the statement to run instead of p, which is p itself unless it branches
+// on a constant
+Stmt* ConstantFolder::foldStmt(Stmt* p) {
+    switch (kindOf(p)) {
+    case NodeKind::BStmt: foldBlock(static_cast<BStmt*>(p)->blk_); return p;
+    case NodeKind::Decl:
+        for (Item* item : *static_cast<Decl*>(p)->listitem_)
+            if (kindOf(item) == NodeKind::Init) {
+                auto init = static_cast<Init*>(item);
+                init->expr_ = foldExpr(init->expr_);
+            }
+        return p;
+    case NodeKind::Ass: {
+        auto ass = static_cast<Ass*>(p);
+        ass->expr_1 = foldExpr(ass->expr_1);
+        ass->expr_2 = foldExpr(ass->expr_2);
+        return p;
+    }
+    case NodeKind::Ret: {
+        auto ret = static_cast<Ret*>(p);
+        ret->expr_ = foldExpr(ret->expr_);
+        return p;
+    }
+    case NodeKind::SExp: {
+        auto sExp = static_cast<SExp*>(p);
+        sExp->expr_ = foldExpr(sExp->expr_);
+        return p;
+    }
+    case NodeKind::Cond: {
+        auto cond = static_cast<Cond*>(p);
+        cond->expr_ = foldExpr(cond->expr_);
+        cond->stmt_ = foldStmt(cond->stmt_);
+        if (Expr* lit = literal(cond->expr_)) {
+            if (boolValue(lit))
+                return cond->stmt_;
+            if (canDrop(cond->stmt_))
+                return make<Empty>();
+        }
+        return p;
+    }
+    case NodeKind::CondElse: {
+        auto cond = static_cast<CondElse*>(p);
+        cond->expr_ = foldExpr(cond->expr_);
+        cond->stmt_1 = foldStmt(cond->stmt_1);
+        cond->stmt_2 = foldStmt(cond->stmt_2);
+        if (Expr* lit = literal(cond->expr_)) {
+            if (boolValue(lit) && canDrop(cond->stmt_2))
+                return cond->stmt_1;
+            if (!boolValue(lit) && canDrop(cond->stmt_1))
+                return cond->stmt_2;
+        }
+        return p;
+    }
+    case NodeKind::While: {
+        // while (true) is kept, the loop only ends with a return
+        auto loop = static_cast<While*>(p);
+        loop->expr_ = foldExpr(loop->expr_);
+        loop->stmt_ = foldStmt(loop->stmt_);
+        Expr* lit = literal(loop->expr_);
+        if (lit && !boolValue(lit) && canDrop(loop->stmt_))
+            return make<Empty>();
+        return p;
+    }
+    case NodeKind::For: {
+        auto loop = static_cast<For*>(p);
+        loop->expr_ = foldExpr(loop->expr_);
+        loop->stmt_ = foldStmt(loop->stmt_);
+        return p;
+    }
+    default: return p; // Empty, Incr, Decr, VRet
+    }
+}
+
+void ConstantFolder::foldDim(ExpDim* p) {
+    auto dim = static_cast<ExpDimen*>(p); // The only kind of ExpDim
+    dim->expr_ = foldExpr(dim->expr_);
+}
+
+// Folds the subexpressions of p, and returns the literal it evaluates to if they
+// are all constant. Otherwise p itself.
+Expr* ConstantFolder::foldExpr(Expr* p) {
+    switch (kindOf(p)) {
+    case NodeKind::ETyped: {
+        auto typed = static_cast<ETyped*>(p);
+        typed->expr_ = foldExpr(typed->expr_);
+        return p;
+    }
+    case NodeKind::EApp:
+        for (Expr*& arg : *static_cast<EApp*>(p)->listexpr_)
+            arg = foldExpr(arg);
+        return p;
+    case NodeKind::EIndex: {
+        auto index = static_cast<EIndex*>(p);
+        index->expr_ = foldExpr(index->expr_);
+        foldDim(index->expdim_);
+        return p;
+    }
+    case NodeKind::EArrNew:
+        for (ExpDim* dim : *static_cast<EArrNew*>(p)->listexpdim_)
+            foldDim(dim);
+        return p;
+    case NodeKind::EArrLen: {
+        auto len = static_cast<EArrLen*>(p);
+        len->expr_ = foldExpr(len->expr_);
+        return p;
+    }
+    case NodeKind::Neg: {
+        auto neg = static_cast<Neg*>(p);
+        neg->expr_ = foldExpr(neg->expr_);
+        Expr* lit = literal(neg->expr_);
+        if (!lit)
+            return p;
+        if (kindOf(lit) == NodeKind::ELitDoub)
+            return make<ELitDoub>(-doubleValue(lit));
+        return make<ELitInt>(wrap(0u - std::uint32_t(intValue(lit))));
+    }
+    case NodeKind::Not: {
+        auto negation = static_cast<Not*>(p);
+        negation->expr_ = foldExpr(negation->expr_);
+        Expr* lit = literal(negation->expr_);
+        return lit ? boolLiteral(!boolValue(lit)) : p;
+    }
+    case NodeKind::EAdd: {
+        auto add = static_cast<EAdd*>(p);
+        add->expr_1 = foldExpr(add->expr_1);
+        add->expr_2 = foldExpr(add->expr_2);
+        Expr* folded = foldArithmetic(add->addop_, add->expr_1, add->expr_2);
+        return folded ? folded : p;
+    }
+    case NodeKind::EMul: {
+        auto mul = static_cast<EMul*>(p);
+        mul->expr_1 = foldExpr(mul->expr_1);
+        mul->expr_2 = foldExpr(mul->expr_2);
+        Expr* folded = foldArithmetic(mul->mulop_, mul->expr_1, mul->expr_2);
+        return folded ? folded : p;
+    }
+    case NodeKind::ERel: {
+        auto rel = static_cast<ERel*>(p);
+        rel->expr_1 = foldExpr(rel->expr_1);
+        rel->expr_2 = foldExpr(rel->expr_2);
+        Expr* folded = foldRelation(rel->relop_, rel->expr_1, rel->expr_2);
+        return folded ? folded : p;
+    }
+    // A constant left operand decides whether the right one is evaluated. A constant
+    // right operand can't be dropped, the left one may have side effects.
+    case NodeKind::EAnd: {
+        auto conj = static_cast<EAnd*>(p);
+        conj->expr_1 = foldExpr(conj->expr_1);
+        conj->expr_2 = foldExpr(conj->expr_2);
+        if (Expr* lit = literal(conj->expr_1))
+            return boolValue(lit) ? unwrap(conj->expr_2) : lit;
+        return p;
+    }
+    case NodeKind::EOr: {
+        auto disj = static_cast<EOr*>(p);
+        disj->expr_1 = foldExpr(disj->expr_1);
+        disj->expr_2 = foldExpr(disj->expr_2);
+        if (Expr* lit = literal(disj->expr_1))
+            return boolValue(lit) ? lit : unwrap(disj->expr_2);
+        return p;
+    }
+    default: return p; // Literals, EVar, EString
+    }
+}
+
+// Plus, Minus (AddOp), Times, Div and Mod (MulOp) of two literals, or null
+Expr* ConstantFolder::foldArithmetic(Visitable* op, Expr* left, Expr* right) {
+    Expr* a = literal(left);
+    Expr* b = literal(right);
+    if (!a || !b)
+        return nullptr;
+
+    if (kindOf(a) == NodeKind::ELitDoub) {
+        Double x = doubleValue(a), y = doubleValue(b);
+        switch (kindOf(op)) {
+        case NodeKind::Plus: return make<ELitDoub>(x + y);
+        case NodeKind::Minus: return make<ELitDoub>(x - y);
+        case NodeKind::Times: return make<ELitDoub>(x * y);
+        case NodeKind::Div: return make<ELitDoub>(x / y);
+        default: return nullptr;
+        }
+    }
+
+    Integer x = intValue(a), y = intValue(b);
+    std::uint32_t ux = x, uy = y;
+    switch (kindOf(op)) {
+    case NodeKind::Plus: return make<ELitInt>(wrap(ux + uy));
+    case NodeKind::Minus: return make<ELitInt>(wrap(ux - uy));
+    case NodeKind::Times: return make<ELitInt>(wrap(ux * uy));
+    case NodeKind::Div:
+    case NodeKind::Mod:
+        if (y == 0 || (x == INT_MIN && y == -1))
+            return nullptr;
+        return make<ELitInt>(kindOf(op) == NodeKind::Div ? x / y : x % y);
+    default: return nullptr;
+    }
+}
+
+// Comparison of two literals, or null. Doubles compare like the ordered fcmp of
+// the generated code, for which even != is false if one of them is NaN.
+Expr* ConstantFolder::foldRelation(RelOp* op, Expr* left, Expr* right) {
+    Expr* a = literal(left);
+    Expr* b = literal(right);
+    if (!a || !b)
+        return nullptr;
+
+    auto compare = [op](auto x, auto y) -> Expr* {
+        switch (kindOf(op)) {
+        case NodeKind::LTH: return boolLiteral(x < y);
+        case NodeKind::LE: return boolLiteral(x <= y);
+        case NodeKind::GTH: return boolLiteral(x > y);
+        case NodeKind::GE: return boolLiteral(x >= y);
+        case NodeKind::EQU: return boolLiteral(x == y);
+        case NodeKind::NE: return boolLiteral(x < y || x > y);
+        default: return nullptr;
+        }
+    };
+    switch (kindOf(a)) {
+    case NodeKind::ELitDoub: return compare(doubleValue(a), doubleValue(b));
+    case NodeKind::ELitInt: return compare(intValue(a), intValue(b));
+    default: return compare(boolValue(a), boolValue(b));
+    }
+}
+
+} // namespace jlc::typechecker
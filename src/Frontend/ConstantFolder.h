@@ -0,0 +1,29 @@
+#pragma once
+#include "src/Common/Arena.h"
+
+#include "bnfc/Absyn.H"
+
+namespace jlc::typechecker {
+using namespace bnfc;
+
+// Evaluates the constant subexpressions of the typed AST, like 60 * 60, -1 or
+// !(1 < 2), and replaces if-statements and loops on a constant condition by what is
+// run. Runs after the type checker, so every expression is wrapped in its ETyped,
+// whose type stays the same. Integers wrap around like at run time, and divisions
+// that would trap are left to the program.
+class ConstantFolder {
+    Arena arena_; // Owns the literals and statements it adds to the AST
+
+  public:
+    void run(Prog* p);
+
+  private:
+    void foldBlock(Blk* p);
+    Stmt* foldStmt(Stmt* p);
+    void foldDim(ExpDim* p);
+    Expr* foldExpr(Expr* p);
+    Expr* foldArithmetic(Visitable* op, Expr* left, Expr* right);
+    Expr* foldRelation(RelOp* op, Expr* left, Expr* right);
+};
+
+} // namespace jlc::typechecker
@@ -11,12 +11,12 @@ void IndexChecker::visitEIndex(EIndex* p) {
     checkDimIsInt(p->expdim_, env_);
     Visit(p->expr_);
     Type* indexExprType = getTypeOfIndexExpr(lhsDim_, rhsDim_, baseType_);
-    Return(new ETyped(p, indexExprType));
+    Return(make<ETyped>(p, indexExprType));
 }
 
 void IndexChecker::visitEArrNew(EArrNew* p) {
     lhsDim_ = p->listexpdim_->size();
-    baseType_ = p->type_;
+    baseType_ = env_.types().intern(p->type_);
     for (ExpDim* expDim : *p->listexpdim_) // Check each index is int
         checkDimIsInt(expDim, env_);
 
@@ -28,7 +28,7 @@ void IndexChecker::visitEArrNew(EArrNew* p) {
 
 void IndexChecker::visitEVar(EVar* p) {
     Type* varTy = env_.findVar(p->ident_, p->line_number, p->char_number);
-    if (typecode(varTy) != TypeCode::ARRAY)
+    if (env_.typecode(varTy) != TypeCode::ARRAY)
         throw TypeError("Indexing of non-array type", p->line_number, p->char_number);
 
     Arr* arrTy = (Arr*)varTy;
@@ -44,7 +44,7 @@ void IndexChecker::visitEVar(EVar* p) {
 void IndexChecker::visitEApp(EApp* p) {
     auto fnType = env_.findFn(p->ident_, p->line_number, p->char_number);
     Type* retType = fnType.ret;
-    if (typecode(retType) != TypeCode::ARRAY)
+    if (env_.typecode(retType) != TypeCode::ARRAY)
         throw TypeError("Indexing of non-array type", p->line_number, p->char_number);
 
     Arr* arrTy = (Arr*)retType;
@@ -102,8 +102,7 @@ Type* IndexChecker::getTypeOfIndexExpr(std::size_t lhsDim, std::size_t rhsDim,
                                        Type* baseType) {
     if (rhsDim == lhsDim)
         return baseType;
-    ListDim* listDim = newArrayWithNDimensions(lhsDim - rhsDim);
-    return new Arr(baseType, listDim);
+    return env_.types().array(baseType, lhsDim - rhsDim);
 }
 
 } // namespace jlc::typechecker
@@ -0,0 +1,135 @@
+#include "Frontend/Interface.h"
+#include "Frontend/TypeError.h"
+
+#include <cctype>
+#include <optional>
+
+namespace jlc::typechecker {
+
+namespace {
+
+void writeType(std::ostream& os, Type* t) {
+    switch (kindOf(t)) {
+    case NodeKind::Int: os << "int"; break;
+    case NodeKind::Doub: os << "double"; break;
+    case NodeKind::Bool: os << "boolean"; break;
+    case NodeKind::Void: os << "void"; break;
+    case NodeKind::Arr: {
+        auto arr = static_cast<Arr*>(t);
+        writeType(os, arr->type_);
+        for (std::size_t i = 0; i < arr->listdim_->size(); i++)
+            os << "[]";
+        break;
+    }
+    default: break; // Strings are only literals, never in a signature
+    }
+}
+
+// Reads one signature, "type ident(type, ...);"
+class SignatureReader {
+    const std::string& line_;
+    std::size_t pos_ = 0;
+    TypeTable& types_;
+
+    void skipSpace() {
+        while (pos_ < line_.size() && std::isspace(static_cast<unsigned char>(line_[pos_])))
+            pos_++;
+    }
+
+    bool accept(const std::string& token) {
+        skipSpace();
+        if (line_.compare(pos_, token.size(), token) != 0)
+            return false;
+        pos_ += token.size();
+        return true;
+    }
+
+    // A Javalette identifier, a letter followed by letters, digits, _ and '
+    std::string ident() {
+        skipSpace();
+        std::size_t start = pos_;
+        if (pos_ < line_.size() && std::isalpha(static_cast<unsigned char>(line_[pos_])))
+            while (++pos_ < line_.size() &&
+                   (std::isalnum(static_cast<unsigned char>(line_[pos_])) ||
+                    line_[pos_] == '_' || line_[pos_] == '\''))
+                ;
+        return line_.substr(start, pos_ - start);
+    }
+
+    Type* type() {
+        std::string name = ident();
+        Type* base = name == "int"       ? types_.get(TypeCode::INT)
+                     : name == "double"  ? types_.get(TypeCode::DOUBLE)
+                     : name == "boolean" ? types_.get(TypeCode::BOOLEAN)
+                     : name == "void"    ? types_.get(TypeCode::VOID)
+                                         : nullptr;
+        std::size_t dims = 0;
+        while (base && accept("[]"))
+            dims++;
+        return base ? types_.array(base, dims) : nullptr;
+    }
+
+  public:
+    SignatureReader(const std::string& line, TypeTable& types)
+        : line_(line), types_(types) {}
+
+    std::optional<Signature> read() {
+        Signature signature;
+        signature.type.ret = type();
+        signature.name = ident();
+        if (!signature.type.ret || signature.name.empty() || !accept("("))
+            return std::nullopt;
+        if (!accept(")")) {
+            do {
+                Type* arg = type();
+                if (!arg || arg == types_.get(TypeCode::VOID))
+                    return std::nullopt;
+                signature.type.args.push_back(arg);
+            } while (accept(","));
+            if (!accept(")"))
+                return std::nullopt;
+        }
+        if (!accept(";"))
+            return std::nullopt;
+        skipSpace();
+        if (pos_ != line_.size())
+            return std::nullopt;
+        return signature;
+    }
+};
+
+} // namespace
+
+void writeInterface(std::ostream& os, Prog* p) {
+    for (TopDef* def : *static_cast<Program*>(p)->listtopdef_) {
+        auto fn = static_cast<FnDef*>(def); // The only kind of TopDef
+        writeType(os, fn->type_);
+        os << " " << fn->ident_ << "(";
+        const char* separator = "";
+        for (Arg* arg : *fn->listarg_) {
+            os << separator;
+            writeType(os, static_cast<Argument*>(arg)->type_);
+            separator = ", ";
+        }
+        os << ");\n";
+    }
+}
+
+std::vector<Signature> readInterface(std::istream& is, const std::string& fileName,
+                                     TypeTable& types) {
+    std::vector<Signature> signatures;
+    std::string line;
+    for (int lineNr = 1; std::getline(is, line); lineNr++) {
+        line = line.substr(0, line.find("//"));
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+        std::optional<Signature> signature = SignatureReader(line, types).read();
+        if (!signature)
+            throw TypeError("Invalid signature on line " + std::to_string(lineNr) +
+                            " of interface '" + fileName + "'");
+        signatures.push_back(std::move(*signature));
+    }
+    return signatures;
+}
+
+} // namespace jlc::typechecker
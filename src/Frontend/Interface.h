@@ -0,0 +1,26 @@
+#pragma once
+#include "Frontend/TypeCheckerEnv.h"
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace jlc::typechecker {
+
+// The interface of a separately compiled module (.jli) lists the functions it
+// defines, one signature per line in source order, like
+//
+//     int sum(int[], int);
+//     double[][] identity(int);
+//
+// A module is type checked and built against the interfaces of the modules it
+// calls, so it only has to be compiled again when one of them changes.
+void writeInterface(std::ostream& os, Prog* p);
+
+// The signatures of an interface, with canonical types. Throws TypeError on a line
+// that isn't a signature, naming the file.
+std::vector<Signature> readInterface(std::istream& is, const std::string& fileName,
+                                     TypeTable& types);
+
+} // namespace jlc::typechecker
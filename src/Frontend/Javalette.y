@@ -27,6 +27,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "Absyn.H"
+#include "../src/Common/Arena.h"
 
 #define YYMAXDEPTH 10000000
 
@@ -170,119 +171,119 @@ extern int yylex(YYSTYPE *lvalp, YYLTYPE *llocp, yyscan_t scanner);
 
 %%
 
-Prog : ListTopDef { std::reverse($1->begin(),$1->end()) ;$$ = new bnfc::Program($1); $$->line_number = @$.first_line; $$->char_number = @$.first_column; result->prog_ = $$; }
+Prog : ListTopDef { std::reverse($1->begin(),$1->end()) ;$$ = jlc::make<bnfc::Program>($1); $$->line_number = @$.first_line; $$->char_number = @$.first_column; result->prog_ = $$; }
 ;
-TopDef : Type _IDENT_ _LPAREN ListArg _RPAREN Blk { std::reverse($4->begin(),$4->end()) ;$$ = new bnfc::FnDef($1, $2, $4, $6); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+TopDef : Type _IDENT_ _LPAREN ListArg _RPAREN Blk { std::reverse($4->begin(),$4->end()) ;$$ = jlc::make<bnfc::FnDef>($1, $2, $4, $6); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
 ;
-ListTopDef : TopDef { $$ = new bnfc::ListTopDef(); $$->push_back($1); }
+ListTopDef : TopDef { $$ = jlc::make<bnfc::ListTopDef>(); $$->push_back($1); }
   | TopDef ListTopDef { $2->push_back($1); $$ = $2; }
 ;
-Arg : Type _IDENT_ { $$ = new bnfc::Argument($1, $2); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+Arg : Type _IDENT_ { $$ = jlc::make<bnfc::Argument>($1, $2); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
 ;
-ListArg : /* empty */ { $$ = new bnfc::ListArg(); }
-  | Arg { $$ = new bnfc::ListArg(); $$->push_back($1); }
+ListArg : /* empty */ { $$ = jlc::make<bnfc::ListArg>(); }
+  | Arg { $$ = jlc::make<bnfc::ListArg>(); $$->push_back($1); }
   | Arg _COMMA ListArg { $3->push_back($1); $$ = $3; }
 ;
-Blk : _LBRACE ListStmt _RBRACE { $$ = new bnfc::Block($2); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+Blk : _LBRACE ListStmt _RBRACE { $$ = jlc::make<bnfc::Block>($2); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
 ;
-ListStmt : /* empty */ { $$ = new bnfc::ListStmt(); }
+ListStmt : /* empty */ { $$ = jlc::make<bnfc::ListStmt>(); }
   | ListStmt Stmt { $1->push_back($2); $$ = $1; }
 ;
-Stmt : _SEMI { $$ = new bnfc::Empty(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | Blk { $$ = new bnfc::BStmt($1); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | Type ListItem _SEMI { std::reverse($2->begin(),$2->end()) ;$$ = new bnfc::Decl($1, $2); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | Expr _EQ Expr _SEMI { $$ = new bnfc::Ass($1, $3); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _IDENT_ _DPLUS _SEMI { $$ = new bnfc::Incr($1); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _IDENT_ _DMINUS _SEMI { $$ = new bnfc::Decr($1); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _KW_return Expr _SEMI { $$ = new bnfc::Ret($2); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _KW_return _SEMI { $$ = new bnfc::VRet(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _KW_if _LPAREN Expr _RPAREN Stmt { $$ = new bnfc::Cond($3, $5); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _KW_if _LPAREN Expr _RPAREN Stmt _KW_else Stmt { $$ = new bnfc::CondElse($3, $5, $7); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _KW_while _LPAREN Expr _RPAREN Stmt { $$ = new bnfc::While($3, $5); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _KW_for _LPAREN Type _IDENT_ _COLON Expr _RPAREN Stmt { $$ = new bnfc::For($3, $4, $6, $8); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | Expr _SEMI { $$ = new bnfc::SExp($1); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+Stmt : _SEMI { $$ = jlc::make<bnfc::Empty>(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | Blk { $$ = jlc::make<bnfc::BStmt>($1); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | Type ListItem _SEMI { std::reverse($2->begin(),$2->end()) ;$$ = jlc::make<bnfc::Decl>($1, $2); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | Expr _EQ Expr _SEMI { $$ = jlc::make<bnfc::Ass>($1, $3); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _IDENT_ _DPLUS _SEMI { $$ = jlc::make<bnfc::Incr>($1); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _IDENT_ _DMINUS _SEMI { $$ = jlc::make<bnfc::Decr>($1); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _KW_return Expr _SEMI { $$ = jlc::make<bnfc::Ret>($2); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _KW_return _SEMI { $$ = jlc::make<bnfc::VRet>(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _KW_if _LPAREN Expr _RPAREN Stmt { $$ = jlc::make<bnfc::Cond>($3, $5); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _KW_if _LPAREN Expr _RPAREN Stmt _KW_else Stmt { $$ = jlc::make<bnfc::CondElse>($3, $5, $7); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _KW_while _LPAREN Expr _RPAREN Stmt { $$ = jlc::make<bnfc::While>($3, $5); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _KW_for _LPAREN Type _IDENT_ _COLON Expr _RPAREN Stmt { $$ = jlc::make<bnfc::For>($3, $4, $6, $8); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | Expr _SEMI { $$ = jlc::make<bnfc::SExp>($1); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
 ;
-Item : _IDENT_ { $$ = new bnfc::NoInit($1); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _IDENT_ _EQ Expr { $$ = new bnfc::Init($1, $3); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+Item : _IDENT_ { $$ = jlc::make<bnfc::NoInit>($1); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _IDENT_ _EQ Expr { $$ = jlc::make<bnfc::Init>($1, $3); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
 ;
-ListItem : Item { $$ = new bnfc::ListItem(); $$->push_back($1); }
+ListItem : Item { $$ = jlc::make<bnfc::ListItem>(); $$->push_back($1); }
   | Item _COMMA ListItem { $3->push_back($1); $$ = $3; }
 ;
-Dim : _EMPTYBRACK { $$ = new bnfc::Dimension(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+Dim : _EMPTYBRACK { $$ = jlc::make<bnfc::Dimension>(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
 ;
-Type1 : _KW_int { $$ = new bnfc::Int(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _KW_double { $$ = new bnfc::Doub(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _KW_boolean { $$ = new bnfc::Bool(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _KW_void { $$ = new bnfc::Void(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+Type1 : _KW_int { $$ = jlc::make<bnfc::Int>(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _KW_double { $$ = jlc::make<bnfc::Doub>(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _KW_boolean { $$ = jlc::make<bnfc::Bool>(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _KW_void { $$ = jlc::make<bnfc::Void>(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
   | _LPAREN Type _RPAREN { $$ = $2; $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
 ;
-Type : Type1 ListDim { std::reverse($2->begin(),$2->end()) ;$$ = new bnfc::Arr($1, $2); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+Type : Type1 ListDim { std::reverse($2->begin(),$2->end()) ;$$ = jlc::make<bnfc::Arr>($1, $2); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
   | Type1 { $$ = $1; $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
 ;
-ListType : /* empty */ { $$ = new bnfc::ListType(); }
-  | Type { $$ = new bnfc::ListType(); $$->push_back($1); }
+ListType : /* empty */ { $$ = jlc::make<bnfc::ListType>(); }
+  | Type { $$ = jlc::make<bnfc::ListType>(); $$->push_back($1); }
   | Type _COMMA ListType { $3->push_back($1); $$ = $3; }
 ;
-ListDim : Dim { $$ = new bnfc::ListDim(); $$->push_back($1); }
+ListDim : Dim { $$ = jlc::make<bnfc::ListDim>(); $$->push_back($1); }
   | Dim ListDim { $2->push_back($1); $$ = $2; }
 ;
-ExpDim : _LBRACK Expr _RBRACK { $$ = new bnfc::ExpDimen($2); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+ExpDim : _LBRACK Expr _RBRACK { $$ = jlc::make<bnfc::ExpDimen>($2); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
 ;
-Expr8 : Expr8 ExpDim { $$ = new bnfc::EIndex($1, $2); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _IDENT_ { $$ = new bnfc::EVar($1); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _IDENT_ _LPAREN ListExpr _RPAREN { std::reverse($3->begin(),$3->end()) ;$$ = new bnfc::EApp($1, $3); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+Expr8 : Expr8 ExpDim { $$ = jlc::make<bnfc::EIndex>($1, $2); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _IDENT_ { $$ = jlc::make<bnfc::EVar>($1); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _IDENT_ _LPAREN ListExpr _RPAREN { std::reverse($3->begin(),$3->end()) ;$$ = jlc::make<bnfc::EApp>($1, $3); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
   | _LPAREN Expr _RPAREN { $$ = $2; $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
 ;
-Expr7 : _KW_new Type ListExpDim { $$ = new bnfc::EArrNew($2, $3); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+Expr7 : _KW_new Type ListExpDim { $$ = jlc::make<bnfc::EArrNew>($2, $3); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
   | Expr8 { $$ = $1; $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
 ;
-Expr6 : Expr7 _DOT _IDENT_ { $$ = new bnfc::EArrLen($1, $3); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _INTEGER_ { $$ = new bnfc::ELitInt($1); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _DOUBLE_ { $$ = new bnfc::ELitDoub($1); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _KW_true { $$ = new bnfc::ELitTrue(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _KW_false { $$ = new bnfc::ELitFalse(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _STRING_ { $$ = new bnfc::EString($1); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+Expr6 : Expr7 _DOT _IDENT_ { $$ = jlc::make<bnfc::EArrLen>($1, $3); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _INTEGER_ { $$ = jlc::make<bnfc::ELitInt>($1); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _DOUBLE_ { $$ = jlc::make<bnfc::ELitDoub>($1); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _KW_true { $$ = jlc::make<bnfc::ELitTrue>(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _KW_false { $$ = jlc::make<bnfc::ELitFalse>(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _STRING_ { $$ = jlc::make<bnfc::EString>($1); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
   | Expr7 { $$ = $1; $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
 ;
-Expr5 : _MINUS Expr6 { $$ = new bnfc::Neg($2); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _BANG Expr6 { $$ = new bnfc::Not($2); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+Expr5 : _MINUS Expr6 { $$ = jlc::make<bnfc::Neg>($2); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _BANG Expr6 { $$ = jlc::make<bnfc::Not>($2); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
   | Expr6 { $$ = $1; $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
 ;
-Expr4 : Expr4 MulOp Expr5 { $$ = new bnfc::EMul($1, $2, $3); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+Expr4 : Expr4 MulOp Expr5 { $$ = jlc::make<bnfc::EMul>($1, $2, $3); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
   | Expr5 { $$ = $1; $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
 ;
-Expr3 : Expr3 AddOp Expr4 { $$ = new bnfc::EAdd($1, $2, $3); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+Expr3 : Expr3 AddOp Expr4 { $$ = jlc::make<bnfc::EAdd>($1, $2, $3); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
   | Expr4 { $$ = $1; $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
 ;
-Expr2 : Expr2 RelOp Expr3 { $$ = new bnfc::ERel($1, $2, $3); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+Expr2 : Expr2 RelOp Expr3 { $$ = jlc::make<bnfc::ERel>($1, $2, $3); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
   | Expr3 { $$ = $1; $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
 ;
-Expr1 : Expr2 _DAMP Expr1 { $$ = new bnfc::EAnd($1, $3); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+Expr1 : Expr2 _DAMP Expr1 { $$ = jlc::make<bnfc::EAnd>($1, $3); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
   | Expr2 { $$ = $1; $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
 ;
-Expr : Expr1 _DBAR Expr { $$ = new bnfc::EOr($1, $3); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+Expr : Expr1 _DBAR Expr { $$ = jlc::make<bnfc::EOr>($1, $3); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
   | Expr1 { $$ = $1; $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
 ;
-ListExpr : /* empty */ { $$ = new bnfc::ListExpr(); }
-  | Expr { $$ = new bnfc::ListExpr(); $$->push_back($1); }
+ListExpr : /* empty */ { $$ = jlc::make<bnfc::ListExpr>(); }
+  | Expr { $$ = jlc::make<bnfc::ListExpr>(); $$->push_back($1); }
   | Expr _COMMA ListExpr { $3->push_back($1); $$ = $3; }
 ;
-ListExpDim : /* empty */ { $$ = new bnfc::ListExpDim(); }
+ListExpDim : /* empty */ { $$ = jlc::make<bnfc::ListExpDim>(); }
   | ListExpDim ExpDim { $1->push_back($2); $$ = $1; }
 ;
-AddOp : _PLUS { $$ = new bnfc::Plus(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _MINUS { $$ = new bnfc::Minus(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+AddOp : _PLUS { $$ = jlc::make<bnfc::Plus>(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _MINUS { $$ = jlc::make<bnfc::Minus>(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
 ;
-MulOp : _STAR { $$ = new bnfc::Times(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _SLASH { $$ = new bnfc::Div(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _PERCENT { $$ = new bnfc::Mod(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+MulOp : _STAR { $$ = jlc::make<bnfc::Times>(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _SLASH { $$ = jlc::make<bnfc::Div>(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _PERCENT { $$ = jlc::make<bnfc::Mod>(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
 ;
-RelOp : _LT { $$ = new bnfc::LTH(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _LDARROW { $$ = new bnfc::LE(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _GT { $$ = new bnfc::GTH(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _GTEQ { $$ = new bnfc::GE(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _DEQ { $$ = new bnfc::EQU(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
-  | _BANGEQ { $$ = new bnfc::NE(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+RelOp : _LT { $$ = jlc::make<bnfc::LTH>(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _LDARROW { $$ = jlc::make<bnfc::LE>(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _GT { $$ = jlc::make<bnfc::GTH>(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _GTEQ { $$ = jlc::make<bnfc::GE>(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _DEQ { $$ = jlc::make<bnfc::EQU>(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
+  | _BANGEQ { $$ = jlc::make<bnfc::NE>(); $$->line_number = @$.first_line; $$->char_number = @$.first_column; }
 ;
 
 %%
@@ -2,6 +2,7 @@
 #include "bnfc/Absyn.H"
 #include "bnfc/Parser.H"
 #include "bnfc/ParserError.H"
+#include "src/Common/Arena.h"
 #include <chrono>
 #include <cstdio>
 #include <memory>
@@ -11,9 +12,11 @@
 namespace jlc {
 
 class Parser {
+    Arena arena_; // Owns the nodes of the AST
     bnfc::Prog* p_ = nullptr;
   public:
     void run(FILE* in) {
+        Arena::Scope scope(arena_);
         p_ = bnfc::pProg(in);
         if(p_ == nullptr)
             throw std::exception();
@@ -13,7 +13,7 @@ void StatementChecker::visitListStmt(ListStmt* p) {
     // Check that non-void functions always return
     ReturnChecker returnChecker(env_);
     bool returns = returnChecker.Visit(p);
-    if (!returns && typecode(currentFn_.type.ret) != TypeCode::VOID)
+    if (!returns && env_.typecode(currentFn_.type.ret) != TypeCode::VOID)
         throw TypeError("Non-void function " + currentFn_.name +
                         " has to always return a value");
 }
@@ -26,25 +26,25 @@ void StatementChecker::visitBStmt(BStmt* p) {
 
 void StatementChecker::visitDecr(Decr* p) {
     Type* varType = env_.findVar(p->ident_, p->line_number, p->char_number);
-    if (typecode(varType) != TypeCode::INT) {
+    if (env_.typecode(varType) != TypeCode::INT) {
         throw TypeError("Cannot decrement " + p->ident_ + " of type " +
-                            toString(typecode(varType)) + ", expected type int",
+                            toString(env_.typecode(varType)) + ", expected type int",
                         p->line_number, p->char_number);
     }
 }
 
 void StatementChecker::visitIncr(Incr* p) {
     Type* varType = env_.findVar(p->ident_, p->line_number, p->char_number);
-    if (typecode(varType) != TypeCode::INT) {
+    if (env_.typecode(varType) != TypeCode::INT) {
         throw TypeError("Cannot increment " + p->ident_ + " of type " +
-                            toString(typecode(varType)) + ", expected type int",
+                            toString(env_.typecode(varType)) + ", expected type int",
                         p->line_number, p->char_number);
     }
 }
 
 void StatementChecker::visitCond(Cond* p) {
     ETyped* exprTyped = infer(p->expr_, env_);
-    if (typecode(exprTyped) != TypeCode::BOOLEAN) {
+    if (env_.typecode(exprTyped->type_) != TypeCode::BOOLEAN) {
         throw TypeError("Expected boolean in cond, got " + toString(exprTyped),
                         p->line_number, p->char_number);
     }
@@ -55,7 +55,7 @@ void StatementChecker::visitCond(Cond* p) {
 
 void StatementChecker::visitCondElse(CondElse* p) {
     ETyped* exprTyped = infer(p->expr_, env_);
-    if (typecode(exprTyped) != TypeCode::BOOLEAN) {
+    if (env_.typecode(exprTyped->type_) != TypeCode::BOOLEAN) {
         throw TypeError("Expected boolean in cond, got " + toString(exprTyped),
                         p->line_number, p->char_number);
     }
@@ -68,7 +68,7 @@ void StatementChecker::visitCondElse(CondElse* p) {
 void StatementChecker::visitWhile(While* p) {
     ETyped* exprTyped = infer(p->expr_, env_);
 
-    if (typecode(exprTyped) != TypeCode::BOOLEAN) {
+    if (env_.typecode(exprTyped->type_) != TypeCode::BOOLEAN) {
         throw TypeError("Expected boolean in cond, got " + toString(exprTyped),
                         p->line_number, p->char_number);
     }
@@ -80,33 +80,24 @@ void StatementChecker::visitWhile(While* p) {
 void StatementChecker::visitFor(For* p) {
     ETyped* arrExpr = infer(p->expr_, env_);
 
-    if (typecode(arrExpr) != TypeCode::ARRAY) {
+    if (env_.typecode(arrExpr->type_) != TypeCode::ARRAY) {
         throw TypeError("Expr in for-loop has to be of array-type", p->line_number,
                         p->char_number);
     }
 
-    auto arr = dynamic_cast<Arr*>(arrExpr->type_);
-    if (auto iterator = dynamic_cast<Arr*>(p->type_)) {
-        if (iterator->listdim_->size() != arr->listdim_->size() - 1) {
-            throw TypeError("Iterator should be element type of array", p->line_number,
-                            p->char_number);
-        }
-    } else {
-        if (arr->listdim_->size() != 1) {
-            throw TypeError("Iterator should be element type of array", p->line_number,
-                            p->char_number);
-        }
-        if (!typesEqual(p->type_, arr->type_)) {
-            throw TypeError("Iterator should be element type of array", p->line_number,
-                            p->char_number);
-        }
+    // The iterator has the type of the array with one dimension less
+    auto arr = static_cast<Arr*>(arrExpr->type_);
+    p->type_ = env_.types().intern(p->type_);
+    if (!typesEqual(p->type_, env_.types().array(arr->type_, arr->listdim_->size() - 1))) {
+        throw TypeError("Iterator should be element type of array", p->line_number,
+                        p->char_number);
     }
 
     env_.enterScope();
     env_.addVar(p->ident_, p->type_);
     // Special logic in for-loop regarding iterator variable
-    if (auto bStmt = dynamic_cast<BStmt*>(p->stmt_))
-        Visit(bStmt->blk_);
+    if (kindOf(p->stmt_) == NodeKind::BStmt)
+        Visit(static_cast<BStmt*>(p->stmt_)->blk_);
     else
         Visit(p->stmt_);
     env_.exitScope();
@@ -130,8 +121,8 @@ void StatementChecker::visitAss(Ass* p) {
     ETyped* RHSExpr = infer(p->expr_2, env_);
 
     if (!typesEqual(LHSExpr->type_, RHSExpr->type_)) {
-        throw TypeError("expected type is " + toString(typecode(LHSExpr->type_)) +
-                            ", but got " + toString(typecode(RHSExpr->type_)),
+        throw TypeError("expected type is " + toString(env_.typecode(LHSExpr->type_)) +
+                            ", but got " + toString(env_.typecode(RHSExpr->type_)),
                         p->line_number, p->char_number);
     }
     p->expr_1 = LHSExpr;
@@ -140,9 +131,9 @@ void StatementChecker::visitAss(Ass* p) {
 
 void StatementChecker::visitRet(Ret* p) {
     ETyped* exprTyped = infer(p->expr_, env_);
-    if (typecode(exprTyped) != typecode(currentFn_.type.ret)) {
+    if (!typesEqual(exprTyped->type_, currentFn_.type.ret)) {
         throw TypeError("Expected return type for function " + currentFn_.name + " is " +
-                            toString(typecode(currentFn_.type.ret)) + ", but got " +
+                            toString(env_.typecode(currentFn_.type.ret)) + ", but got " +
                             toString(exprTyped),
                         p->line_number, p->char_number);
     }
@@ -150,9 +141,9 @@ void StatementChecker::visitRet(Ret* p) {
 }
 
 void StatementChecker::visitVRet(VRet* p) {
-    if (TypeCode::VOID != typecode(currentFn_.type.ret)) {
+    if (TypeCode::VOID != env_.typecode(currentFn_.type.ret)) {
         throw TypeError("Expected return type for function " + currentFn_.name + " is " +
-                            toString(typecode(currentFn_.type.ret)) + ", but got " +
+                            toString(env_.typecode(currentFn_.type.ret)) + ", but got " +
                             toString(TypeCode::VOID),
                         p->line_number, p->char_number);
     }
@@ -161,7 +152,7 @@ void StatementChecker::visitVRet(VRet* p) {
 void StatementChecker::visitSExp(SExp* p) {
     // e.g. printString("hello");
     ETyped* exprTyped = infer(p->expr_, env_);
-    if (typecode(exprTyped) != TypeCode::VOID)
+    if (env_.typecode(exprTyped->type_) != TypeCode::VOID)
         throw TypeError("Expression should be of type void", p->line_number,
                         p->char_number);
     p->expr_ = exprTyped;
@@ -175,6 +166,7 @@ void StatementChecker::visitEmpty(Empty* p) {
 /********************   DeclHandler class    ********************/
 
 void DeclHandler::visitDecl(Decl* p) {
+    p->type_ = env_.types().intern(p->type_);
     LHSType = p->type_;
     Visit(p->listitem_);
 }
@@ -189,7 +181,7 @@ void DeclHandler::visitInit(Init* p) {
     ETyped* RHSExpr = infer(p->expr_, env_);
 
     if (!typesEqual(LHSType, RHSExpr->type_)) {
-        throw TypeError("expected type is " + toString(typecode(LHSType)) + ", but got " +
+        throw TypeError("expected type is " + toString(env_.typecode(LHSType)) + ", but got " +
                             toString(RHSExpr),
                         p->expr_->line_number, p->expr_->char_number);
     }
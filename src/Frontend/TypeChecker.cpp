@@ -3,6 +3,7 @@
 #include "Frontend/StatementChecker.h"
 #include "Frontend/TypeInferrer.h"
 #include "Common/Util.h"
+#include "llvm/Support/TimeProfiler.h"
 namespace jlc::typechecker {
 
 /********************   ProgramChecker class   ********************/
@@ -11,18 +12,22 @@ void ProgramChecker::visitProgram(Program* p) { Visit(p->listtopdef_); }
 
 void ProgramChecker::visitListTopDef(ListTopDef* p) {
     // Add the predefined functions
-    env_.addSignature("printInt", {{new Int}, new Void});
-    env_.addSignature("printDouble", {{new Doub}, new Void});
-    env_.addSignature("printString", {{new StringLit}, new Void});
-    env_.addSignature("readInt", {{}, new Int});
-    env_.addSignature("readDouble", {{}, new Doub});
+    TypeTable& types = env_.types();
+    env_.addSignature("printInt", {{types.get(TypeCode::INT)}, types.get(TypeCode::VOID)});
+    env_.addSignature("printDouble",
+                      {{types.get(TypeCode::DOUBLE)}, types.get(TypeCode::VOID)});
+    env_.addSignature("printString",
+                      {{types.get(TypeCode::STRING)}, types.get(TypeCode::VOID)});
+    env_.addSignature("readInt", {{}, types.get(TypeCode::INT)});
+    env_.addSignature("readDouble", {{}, types.get(TypeCode::DOUBLE)});
 
     // First pass to aggregate the list of functions in signatures_
     for (TopDef* fn : *p)
         Visit(fn);
 
     // Check that main exists
-    env_.findFn("main", 1, 1);
+    if (requireMain_)
+        env_.findFn("main", 1, 1);
 
     // Check all the functions one by one
     FunctionChecker functionChecker(env_);
@@ -31,9 +36,14 @@ void ProgramChecker::visitListTopDef(ListTopDef* p) {
 }
 
 void ProgramChecker::visitFnDef(FnDef* p) {
+    // The signature and the AST both get the canonical types
     std::list<Type*> args;
-    for (Arg* arg : *p->listarg_)
-        args.push_back(dynamic_cast<Argument*>(arg)->type_);
+    for (Arg* arg : *p->listarg_) {
+        auto argument = static_cast<Argument*>(arg); // The only kind of Arg
+        argument->type_ = env_.types().intern(argument->type_);
+        args.push_back(argument->type_);
+    }
+    p->type_ = env_.types().intern(p->type_);
 
     env_.addSignature(p->ident_, {args, p->type_});
 }
@@ -41,6 +51,7 @@ void ProgramChecker::visitFnDef(FnDef* p) {
 /********************   FunctionChecker class    ********************/
 
 void FunctionChecker::visitFnDef(FnDef* p) {
+    llvm::TimeTraceScope trace("Typecheck function", p->ident_);
     env_.enterFn(p->ident_); // So that StatementChecker will be aware of the fn.
     env_.enterScope();
     Visit(p->listarg_);
@@ -67,9 +78,10 @@ void FunctionChecker::visitArgument(Argument* p) {
 /********************   Helper functions    ********************/
 
 void checkDimIsInt(ExpDim* p, Env& env) {
-    if (auto expDim = dynamic_cast<ExpDimen*>(p)) { // Index explicitly stated
+    if (kindOf(p) == NodeKind::ExpDimen) { // Index explicitly stated
+        auto expDim = static_cast<ExpDimen*>(p);
         ETyped* eTyped = infer(expDim->expr_, env);
-        if (typecode(eTyped->type_) != TypeCode::INT) { // Check index INT
+        if (env.typecode(eTyped->type_) != TypeCode::INT) { // Check index INT
             throw TypeError("Only integer indices allowed", p->line_number,
                             p->char_number);
         }
@@ -111,25 +123,35 @@ std::string toString(OpCode c) {
     }
 }
 
-Type* newType(TypeCode t) {
-    switch (t) {
-    case TypeCode::INT: return new Int;
-    case TypeCode::DOUBLE: return new Doub;
-    case TypeCode::BOOLEAN: return new Bool;
-    case TypeCode::VOID: return new Void;
-    case TypeCode::STRING: return new StringLit;
-    default: return new Void;
-    }
-}
-
 TypeCode typecode(Visitable* p) {
-    TypeCoder typeCoder;
-    return typeCoder.Visit(p);
+    switch (kindOf(p)) {
+    case NodeKind::Int: return TypeCode::INT;
+    case NodeKind::Doub: return TypeCode::DOUBLE;
+    case NodeKind::Bool: return TypeCode::BOOLEAN;
+    case NodeKind::Void: return TypeCode::VOID;
+    case NodeKind::StringLit: return TypeCode::STRING;
+    case NodeKind::Arr: return TypeCode::ARRAY;
+    case NodeKind::Argument: return typecode(static_cast<Argument*>(p)->type_);
+    case NodeKind::ETyped: return typecode(static_cast<ETyped*>(p)->type_);
+    default: return TypeCode::ERROR;
+    }
 }
 
 OpCode opcode(Visitable* p) {
-    OpCoder opCoder;
-    return opCoder.Visit(p);
+    switch (kindOf(p)) {
+    case NodeKind::LE: return OpCode::LE;
+    case NodeKind::LTH: return OpCode::LTH;
+    case NodeKind::GE: return OpCode::GE;
+    case NodeKind::EQU: return OpCode::EQU;
+    case NodeKind::NE: return OpCode::NE;
+    case NodeKind::GTH: return OpCode::GTH;
+    case NodeKind::Plus: return OpCode::PLUS;
+    case NodeKind::Minus: return OpCode::MINUS;
+    case NodeKind::Times: return OpCode::TIMES;
+    case NodeKind::Div: return OpCode::DIV;
+    case NodeKind::Mod: return OpCode::MOD;
+    default: throw TypeError("Unknown operator");
+    }
 }
 
 ETyped* infer(Visitable* p, Env& env) {
@@ -137,26 +159,4 @@ ETyped* infer(Visitable* p, Env& env) {
     return inf.Visit(p);
 }
 
-bool typesEqual(Type* left, Type* right) {
-    if (auto arrLeft = dynamic_cast<Arr*>(left)) {
-        if (auto arrRight = dynamic_cast<Arr*>(right)) {
-            return arrLeft->listdim_->size() == arrRight->listdim_->size();
-        } else {
-            return false;
-        }
-    } else {
-        if (auto arrRight = dynamic_cast<Arr*>(right)) {
-            return false;
-        }
-    }
-    return typecode(left) == typecode(right);
-}
-
-ListDim* newArrayWithNDimensions(int N) {
-    ListDim* listDim = new ListDim;
-    for (int i = 0; i < N; i++)
-        listDim->push_back(new Dimension);
-    return listDim;
-}
-
 } // namespace jlc::typechecker
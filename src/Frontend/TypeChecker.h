@@ -1,6 +1,8 @@
 #pragma once
+#include "Interface.h"
 #include "TypeCheckerEnv.h"
 #include "TypeError.h"
+#include "src/Common/Arena.h"
 #include "src/Common/BaseVisitor.h"
 
 #include "bnfc/Absyn.H"
@@ -14,8 +16,6 @@
 namespace jlc::typechecker {
 using namespace bnfc;
 
-enum class TypeCode { INT, DOUBLE, BOOLEAN, VOID, STRING, ARRAY, ERROR };
-
 enum class OpCode {
     LTH,
     LE,
@@ -38,42 +38,13 @@ enum class OpCode {
 std::string toString(TypeCode t);
 std::string toString(ETyped* p);
 std::string toString(OpCode c);
-Type* newType(TypeCode t);
+// Both switch on the kind tag of the node (see NodeKind.h)
 TypeCode typecode(Visitable* p);
 OpCode opcode(Visitable* p);
 ETyped* infer(Visitable* p, Env& env);
 void checkDimIsInt(ExpDim* p, Env& env);
-bool typesEqual(Type* left, Type* right);
-ListDim* newArrayWithNDimensions(int N);
-
-//  Returns the OpCode for an Operation
-class OpCoder : public ValueVisitor<OpCode> {
-  public:
-    void visitLE(LE* p) override { Return(OpCode::LE); }
-    void visitLTH(LTH* p) override { Return(OpCode::LTH); }
-    void visitGE(GE* p) override { Return(OpCode::GE); }
-    void visitEQU(EQU* p) override { Return(OpCode::EQU); }
-    void visitNE(NE* p) override { Return(OpCode::NE); }
-    void visitGTH(GTH* p) override { Return(OpCode::GTH); }
-    void visitPlus(Plus* p) override { Return(OpCode::PLUS); }
-    void visitMinus(Minus* p) override { Return(OpCode::MINUS); }
-    void visitTimes(Times* p) override { Return(OpCode::TIMES); }
-    void visitDiv(Div* p) override { Return(OpCode::DIV); }
-    void visitMod(Mod* p) override { Return(OpCode::MOD); }
-};
-
-//  Returns the TypeCode for a Type
-class TypeCoder : public ValueVisitor<TypeCode> {
-  public:
-    void visitInt(Int* p) override { Return(TypeCode::INT); }
-    void visitDoub(Doub* p) override { Return(TypeCode::DOUBLE); }
-    void visitBool(Bool* p) override { Return(TypeCode::BOOLEAN); }
-    void visitVoid(Void* p) override { Return(TypeCode::VOID); }
-    void visitStringLit(StringLit* p) override { Return(TypeCode::STRING); }
-    void visitArgument(Argument* p) override { Return(Visit(p->type_)); }
-    void visitETyped(ETyped* p) override { Return(Visit(p->type_)); }
-    void visitArr(Arr* p) override { Return(TypeCode::ARRAY); }
-};
+// Types are interned by TypeTable, so equal types are the same node
+inline bool typesEqual(Type* left, Type* right) { return left == right; }
 
 // Checks function definitions / args, then forwards to 'StatementChecker'
 class FunctionChecker : public VoidVisitor {
@@ -90,10 +61,11 @@ class FunctionChecker : public VoidVisitor {
 
 // Checks program level validity, then forwards to 'FunctionChecker'
 class ProgramChecker : public VoidVisitor {
-    Env env_;
+    Env& env_;
+    bool requireMain_;
 
   public:
-    explicit ProgramChecker(Env& env) : env_() {}
+    ProgramChecker(Env& env, bool requireMain) : env_(env), requireMain_(requireMain) {}
 
     void visitListTopDef(ListTopDef* p) override;
     void visitFnDef(FnDef* p) override;
@@ -102,18 +74,32 @@ class ProgramChecker : public VoidVisitor {
 
 // Entrypoint for typechecking
 class TypeChecker {
-    Env env_{};
+    Arena arena_; // Owns the typed expressions and types it adds to the AST
+    Env env_{arena_};
     Prog* p_ = nullptr;
+    std::vector<Signature> imports_;
 
   public:
-    void run(Prog* p) {
-        ProgramChecker programChecker(env_);
+    // Makes the functions of another module callable, before run (see Interface.h)
+    void import(std::istream& is, const std::string& fileName) {
+        for (Signature& fn : readInterface(is, fileName, env_.types())) {
+            env_.addSignature(fn.name, fn.type);
+            imports_.push_back(std::move(fn));
+        }
+    }
+
+    // A module compiled on its own (jlc -c) doesn't need a main
+    void run(Prog* p, bool requireMain = true) {
+        Arena::Scope scope(arena_);
+        ProgramChecker programChecker(env_, requireMain);
         programChecker.Visit(p);
         p_ = p;
     }
 
     Env& getEnv() { return env_; }
 
+    const std::vector<Signature>& getImports() const { return imports_; }
+
     Prog* getAbsyn() { return p_; }
 };
 
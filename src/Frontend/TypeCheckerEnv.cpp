@@ -3,8 +3,8 @@
 
 namespace jlc::typechecker {
 
-void Env::enterScope() { scopes_.push_front(Scope()); }
-void Env::exitScope() { scopes_.pop_front(); }
+void Env::enterScope() { scopes_.enterScope(); }
+void Env::exitScope() { scopes_.exitScope(); }
 void Env::enterFn(const std::string& fnName) {
     currentFn_ = {fnName, findFn(fnName, 1, 1)};
 }
@@ -19,10 +19,8 @@ void Env::addSignature(const std::string& fnName, const FunctionType& t) {
 
 // Called when it's used in an expression, if it doesn't exist, throw
 Type* Env::findVar(const std::string& var, int lineNr, int charNr) {
-    for (auto& scope : scopes_) {
-        if (auto type = map::getValue(var, scope))
-            return *type;
-    }
+    if (Type* const* type = scopes_.find(symbols_.intern(var)))
+        return *type;
     throw TypeError("Variable '" + var + "' not declared in this context", lineNr,
                     charNr);
 }
@@ -34,8 +32,7 @@ FunctionType Env::findFn(const std::string& fn, int lineNr, int charNr) {
 }
 
 void Env::addVar(const std::string& name, Type* t) {
-    Scope& currentScope = scopes_.front();
-    if (auto [_, success] = currentScope.insert({name, t}); !success)
+    if (!scopes_.add(symbols_.intern(name), t))
         throw TypeError("Duplicate variable '" + name + "' in scope");
 }
 
@@ -1,6 +1,8 @@
 #pragma once
 #include "Common/Util.h"
 #include "Common/BaseVisitor.h"
+#include "Common/SymbolTable.h"
+#include "Frontend/TypeTable.h"
 #include "bnfc/Absyn.H"
 #include <list>
 #include <unordered_map>
@@ -20,14 +22,19 @@ struct Signature {
 };
 
 class Env {
-    using Scope = std::unordered_map<std::string, Type*>; // Map of (Var -> Type)
     // Defines the environment of the program
-    std::list<Scope> scopes_;
+    SymbolTable symbols_;
+    ScopeTable<Type*> scopes_; // Var -> Type
     std::unordered_map<std::string, FunctionType> signatures_;
     Signature currentFn_;
+    TypeTable types_;
 
   public:
-    Env() : scopes_(), signatures_(), currentFn_() {}
+    explicit Env(Arena& arena) : scopes_(), signatures_(), currentFn_(), types_(arena) {}
+
+    TypeTable& types() { return types_; }
+    // Only valid for canonical types, see TypeTable
+    TypeCode typecode(const Type* t) const { return types_.code(t); }
 
     void enterScope();
     void exitScope();
@@ -18,13 +18,13 @@ auto TypeInferrer::checkBinExp(Expr* e1, Expr* e2, const std::string& op,
     ETyped* e1Typed = Visit(e1);
     ETyped* e2Typed = Visit(e2);
 
-    if (!typeIn(typecode(e1Typed), allowedTypes) ||
-        !typeIn(typecode(e2Typed), allowedTypes)) {
+    if (!typeIn(env_.typecode(e1Typed->type_), allowedTypes) ||
+        !typeIn(env_.typecode(e2Typed->type_), allowedTypes)) {
         throw TypeError("Invalid operands of types " + toString(e1Typed) + " and " +
                             toString(e2Typed) + " to binary " + op,
                         e1->line_number, e1->char_number);
     }
-    if (typecode(e1Typed) != typecode(e2Typed)) {
+    if (!typesEqual(e1Typed->type_, e2Typed->type_)) {
         throw TypeError("Incompatible operands of types " + toString(e1Typed) + " and " +
                             toString(e2Typed) + " to binary " + op,
                         e1->line_number, e1->char_number);
@@ -36,22 +36,32 @@ auto TypeInferrer::checkUnExp(Expr* e, const std::string& op,
                               std::initializer_list<TypeCode> allowedTypes) {
     ETyped* eTyped = Visit(e);
 
-    if (!typeIn(typecode(eTyped), allowedTypes)) {
+    if (!typeIn(env_.typecode(eTyped->type_), allowedTypes)) {
         throw TypeError("Invalid operand of type " + toString(eTyped) + " to unary " + op,
                         e->line_number, e->char_number);
     }
     return eTyped;
 }
 
-void TypeInferrer::visitELitInt(ELitInt* p) { Return(new ETyped(p, new Int)); }
-void TypeInferrer::visitELitDoub(ELitDoub* p) { Return(new ETyped(p, new Doub)); }
-void TypeInferrer::visitELitFalse(ELitFalse* p) { Return(new ETyped(p, new Bool)); }
-void TypeInferrer::visitELitTrue(ELitTrue* p) { Return(new ETyped(p, new Bool)); }
-void TypeInferrer::visitEString(EString* p) { Return(new ETyped(p, new StringLit)); }
+void TypeInferrer::visitELitInt(ELitInt* p) {
+    Return(make<ETyped>(p, env_.types().get(TypeCode::INT)));
+}
+void TypeInferrer::visitELitDoub(ELitDoub* p) {
+    Return(make<ETyped>(p, env_.types().get(TypeCode::DOUBLE)));
+}
+void TypeInferrer::visitELitFalse(ELitFalse* p) {
+    Return(make<ETyped>(p, env_.types().get(TypeCode::BOOLEAN)));
+}
+void TypeInferrer::visitELitTrue(ELitTrue* p) {
+    Return(make<ETyped>(p, env_.types().get(TypeCode::BOOLEAN)));
+}
+void TypeInferrer::visitEString(EString* p) {
+    Return(make<ETyped>(p, env_.types().get(TypeCode::STRING)));
+}
          
 void TypeInferrer::visitEVar(EVar* p) {
     Type* varType = env_.findVar(p->ident_, p->line_number, p->char_number);
-    Return(new ETyped(p, varType));
+    Return(make<ETyped>(p, varType));
 }
 
 void TypeInferrer::visitListItem(ListItem* p) {
@@ -67,7 +77,7 @@ void TypeInferrer::visitEAdd(EAdd* p) {
                                           {TypeCode::INT, TypeCode::DOUBLE});
     p->expr_1 = e1Typed;
     p->expr_2 = e2Typed;
-    Return(new ETyped(p, e1Typed->type_));
+    Return(make<ETyped>(p, e1Typed->type_));
 }
 
 // Times, Div (INT, DOUBLE)
@@ -81,7 +91,7 @@ void TypeInferrer::visitEMul(EMul* p) {
                           {TypeCode::INT, TypeCode::DOUBLE});
     p->expr_1 = e1Typed;
     p->expr_2 = e2Typed;
-    Return(new ETyped(p, e1Typed->type_));
+    Return(make<ETyped>(p, e1Typed->type_));
 }
 
 // OR (BOOLEAN)
@@ -90,7 +100,7 @@ void TypeInferrer::visitEOr(EOr* p) {
         checkBinExp(p->expr_1, p->expr_2, toString(OpCode::OR), {TypeCode::BOOLEAN});
     p->expr_1 = e1Typed;
     p->expr_2 = e2Typed;
-    Return(new ETyped(p, new Bool));
+    Return(make<ETyped>(p, env_.types().get(TypeCode::BOOLEAN)));
 }
 
 // AND (BOOLEAN)
@@ -99,14 +109,14 @@ void TypeInferrer::visitEAnd(EAnd* p) {
         checkBinExp(p->expr_1, p->expr_2, toString(OpCode::AND), {TypeCode::BOOLEAN});
     p->expr_1 = e1Typed;
     p->expr_2 = e2Typed;
-    Return(new ETyped(p, new Bool));
+    Return(make<ETyped>(p, env_.types().get(TypeCode::BOOLEAN)));
 }
 
 // NOT (BOOLEAN)
 void TypeInferrer::visitNot(Not* p) {
     ETyped* eTyped = checkUnExp(p->expr_, toString(OpCode::NOT), {TypeCode::BOOLEAN});
     p->expr_ = eTyped;
-    Return(new ETyped(p, new Bool));
+    Return(make<ETyped>(p, env_.types().get(TypeCode::BOOLEAN)));
 }
 
 // NEG (INT, DOUBLE)
@@ -114,7 +124,7 @@ void TypeInferrer::visitNeg(Neg* p) {
     ETyped* eTyped =
         checkUnExp(p->expr_, toString(OpCode::NEG), {TypeCode::INT, TypeCode::DOUBLE});
     p->expr_ = eTyped;
-    Return(new ETyped(p, eTyped->type_));
+    Return(make<ETyped>(p, eTyped->type_));
 }
 
 // LTH, LE, GTH, GE (INT, DOUBLE)
@@ -135,7 +145,7 @@ void TypeInferrer::visitERel(ERel* p) {
 
     p->expr_1 = e1Typed;
     p->expr_2 = e2Typed;
-    Return(new ETyped(p, new Bool));
+    Return(make<ETyped>(p, env_.types().get(TypeCode::BOOLEAN)));
 }
 
 void TypeInferrer::visitEApp(EApp* p) {
@@ -152,7 +162,7 @@ void TypeInferrer::visitEApp(EApp* p) {
 
     for (; item != itemEnd && argType != argEnd; ++item, ++argType) {
         ETyped* itemTyped = infer(*item, env_);
-        if (typecode(itemTyped) != typecode(*argType)) {
+        if (!typesEqual(itemTyped->type_, *argType)) {
             throw TypeError("In call to fn " + p->ident_ + ", expected arg " +
                                 toString(typecode(*argType)) + ", but got " +
                                 toString(typecode(itemTyped)),
@@ -161,7 +171,7 @@ void TypeInferrer::visitEApp(EApp* p) {
         *item = itemTyped;
     }
 
-    Return(new ETyped(p, retType));
+    Return(make<ETyped>(p, retType));
 }
 
 void TypeInferrer::visitEArrLen(EArrLen* p) {
@@ -170,13 +180,13 @@ void TypeInferrer::visitEArrLen(EArrLen* p) {
                         p->char_number);
     }
     ETyped* eTyped = Visit(p->expr_);
-    if (!dynamic_cast<Arr*>(eTyped->type_)) {
+    if (env_.typecode(eTyped->type_) != TypeCode::ARRAY) {
         throw TypeError("Can only check length of array type", p->line_number,
                         p->char_number);
     }
 
     p->expr_ = eTyped;
-    Return(new ETyped(p, new Int));
+    Return(make<ETyped>(p, env_.types().get(TypeCode::INT)));
 }
 
 void TypeInferrer::visitEIndex(EIndex* p) {
@@ -184,19 +194,12 @@ void TypeInferrer::visitEIndex(EIndex* p) {
     Return(indexChecker.Visit(p));
 }
 void TypeInferrer::visitEArrNew(EArrNew* p) {
-    Type* baseType = p->type_;
-    int dim = 0;
-    if(auto arr = dynamic_cast<Arr*>(baseType)) {
-        baseType = arr->type_;
-        dim += arr->listdim_->size();
-    }
-    for (ExpDim* dimExp : *p->listexpdim_) { // Check each index is int
+    // An array of arrays is flattened by the type table, new int[] [2] is an int[][]
+    p->type_ = env_.types().intern(p->type_);
+    for (ExpDim* dimExp : *p->listexpdim_) // Check each index is int
         checkDimIsInt(dimExp, env_);
-        dim++;
-    }
 
-    ListDim* listDim = newArrayWithNDimensions(dim);
-    Return(new ETyped(p, new Arr(baseType, listDim)));
+    Return(make<ETyped>(p, env_.types().array(p->type_, p->listexpdim_->size())));
 }
 
 }
@@ -0,0 +1,41 @@
+#include "Frontend/TypeTable.h"
+#include "Frontend/TypeChecker.h"
+
+namespace jlc::typechecker {
+
+TypeTable::TypeTable(Arena& arena) : arena_(arena) {
+    basic_[static_cast<int>(TypeCode::INT)] = arena_.make<Int>();
+    basic_[static_cast<int>(TypeCode::DOUBLE)] = arena_.make<Doub>();
+    basic_[static_cast<int>(TypeCode::BOOLEAN)] = arena_.make<Bool>();
+    basic_[static_cast<int>(TypeCode::VOID)] = arena_.make<Void>();
+    basic_[static_cast<int>(TypeCode::STRING)] = arena_.make<StringLit>();
+}
+
+Type* TypeTable::array(Type* base, std::size_t dims) {
+    // An array of arrays, (int[])[], is the same type as int[][]
+    if (code(base) == TypeCode::ARRAY) {
+        auto inner = static_cast<Arr*>(base);
+        base = inner->type_;
+        dims += inner->listdim_->size();
+    }
+    if (dims == 0)
+        return base;
+    Arr*& arr = arrays_[{base, dims}];
+    if (arr == nullptr) {
+        ListDim* listDim = arena_.make<ListDim>();
+        for (std::size_t i = 0; i < dims; i++)
+            listDim->push_back(arena_.make<Dimension>());
+        arr = arena_.make<Arr>(base, listDim);
+    }
+    return arr;
+}
+
+Type* TypeTable::intern(Type* t) {
+    if (kindOf(t) == NodeKind::Arr) {
+        auto arr = static_cast<Arr*>(t);
+        return array(intern(arr->type_), arr->listdim_->size());
+    }
+    return get(typecode(t));
+}
+
+} // namespace jlc::typechecker
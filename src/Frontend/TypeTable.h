@@ -0,0 +1,40 @@
+#pragma once
+#include "Common/Arena.h"
+#include "bnfc/Absyn.H"
+#include <map>
+#include <utility>
+
+namespace jlc::typechecker {
+
+using namespace bnfc;
+
+enum class TypeCode { INT, DOUBLE, BOOLEAN, VOID, STRING, ARRAY, ERROR };
+
+// Interns the types of the typechecker: each distinct type, arrays included, is a
+// single canonical node, so equal types are the same pointer. The parsed types are
+// replaced by their canonical nodes as the typechecker meets them.
+class TypeTable {
+    Arena& arena_;
+    Type* basic_[5]; // Indexed by TypeCode, INT to STRING
+    std::map<std::pair<Type*, std::size_t>, Arr*> arrays_; // (base, dimensions) -> Arr
+
+  public:
+    explicit TypeTable(Arena& arena);
+
+    // int, double, boolean, void or string
+    Type* get(TypeCode t) const { return basic_[static_cast<int>(t)]; }
+    // The array of 'dims' dimensions of a canonical type, the type itself if dims is 0
+    Type* array(Type* base, std::size_t dims);
+    // The canonical node of a type from the parser
+    Type* intern(Type* t);
+
+    // Only valid for canonical types
+    TypeCode code(const Type* t) const {
+        for (int i = 0; i < 5; i++)
+            if (basic_[i] == t)
+                return static_cast<TypeCode>(i);
+        return TypeCode::ARRAY;
+    }
+};
+
+} // namespace jlc::typechecker
@@ -0,0 +1,71 @@
+#include "BoundsCheckElimination.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+
+namespace jlc::codegen {
+
+using namespace llvm;
+
+// True if index < length (unsigned) holds whenever the branch is reached
+static bool inBounds(ScalarEvolution& se, Value* index, Value* length, BranchInst* br) {
+    const SCEV* i = se.getSCEV(index);
+    const SCEV* len = se.getSCEV(length);
+    if (se.isKnownPredicateAt(ICmpInst::ICMP_ULT, i, len, br))
+        return true;
+    // The conditions of Javalette are signed, as in if (i >= 0 && i < a.length)
+    const SCEV* zero = se.getZero(i->getType());
+    return se.isKnownPredicateAt(ICmpInst::ICMP_SGE, i, zero, br) &&
+           se.isKnownPredicateAt(ICmpInst::ICMP_SLT, i, len, br);
+}
+
+PreservedAnalyses BoundsCheckElimination::run(Function& fn,
+                                              FunctionAnalysisManager& fam) {
+    Function* outOfBounds = fn.getParent()->getFunction("indexOutOfBounds");
+    if (!outOfBounds || outOfBounds->use_empty())
+        return PreservedAnalyses::all();
+
+    ScalarEvolution& se = fam.getResult<ScalarEvolutionAnalysis>(fn);
+    bool changed = false;
+    for (BasicBlock& bb : fn) {
+        auto call = dyn_cast<CallInst>(bb.getFirstNonPHIOrDbg());
+        if (!call || call->getCalledFunction() != outOfBounds)
+            continue;
+
+        // The checks branch here when !(index u< length), possibly flipped and
+        // swapped around by instcombine
+        for (BasicBlock* pred : predecessors(&bb)) {
+            auto br = dyn_cast<BranchInst>(pred->getTerminator());
+            if (!br || !br->isConditional())
+                continue;
+            auto cmp = dyn_cast<ICmpInst>(br->getCondition());
+            if (!cmp)
+                continue;
+            bool failsOnTrue = br->getSuccessor(0) == &bb;
+            if (failsOnTrue && br->getSuccessor(1) == &bb)
+                continue;
+            ICmpInst::Predicate passes =
+                failsOnTrue ? cmp->getInversePredicate() : cmp->getPredicate();
+
+            Value* index = cmp->getOperand(0);
+            Value* length = cmp->getOperand(1);
+            if (passes == ICmpInst::ICMP_UGT)
+                std::swap(index, length);
+            else if (passes != ICmpInst::ICMP_ULT)
+                continue;
+
+            if (inBounds(se, index, length, br)) {
+                br->setCondition(ConstantInt::getBool(fn.getContext(), !failsOnTrue));
+                changed = true;
+            }
+        }
+    }
+    if (!changed)
+        return PreservedAnalyses::all();
+    // Only branch conditions changed, the blocks are still there
+    PreservedAnalyses pa;
+    pa.preserveSet<CFGAnalyses>();
+    return pa;
+}
+
+} // namespace jlc::codegen
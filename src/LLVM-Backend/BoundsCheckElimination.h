@@ -0,0 +1,15 @@
+#pragma once
+#include "llvm/IR/PassManager.h"
+
+namespace jlc::codegen {
+
+// Removes the array bounds checks of --bounds-check that can be proven to pass, such
+// as a[i] in a loop running while i < a.length. A check is the branch in front of a
+// call to the runtime's indexOutOfBounds, which is made unconditional when scalar
+// evolution shows 0 <= index < length there. SimplifyCFG then deletes the dead block.
+class BoundsCheckElimination : public llvm::PassInfoMixin<BoundsCheckElimination> {
+  public:
+    llvm::PreservedAnalyses run(llvm::Function& fn, llvm::FunctionAnalysisManager& fam);
+};
+
+} // namespace jlc::codegen
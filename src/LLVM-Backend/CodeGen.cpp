@@ -1,14 +1,31 @@
+// Included before CodeGen.h, whose builder macros (B, ENV, ...) clash with them
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Linker/Linker.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "llvm/Transforms/Utils/Local.h"
+
 #include "CodeGen.h"
 #include "ProgramBuilder.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/MC/TargetRegistry.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/TimeProfiler.h"
 
 namespace jlc::codegen {
 
-Codegen::Codegen(const std::string& moduleName) {
+Codegen::Codegen(const std::string& moduleName, CodegenOptions options)
+    : options_(options) {
     env_ = std::make_unique<Env>();
     context_ = std::make_unique<LLVMContext>();
     builder_ = std::make_unique<IRBuilder<>>(*context_);
     module_ = std::make_unique<Module>(moduleName, *context_);
 
+    targetMachine_ = createHostTargetMachine();
+    module_->setTargetTriple(targetMachine_->getTargetTriple().str());
+    module_->setDataLayout(targetMachine_->createDataLayout());
+
     int64 = Type::getInt64Ty(*context_);
     int32 = Type::getInt32Ty(*context_);
     int8 = Type::getInt8Ty(*context_);
@@ -17,7 +34,11 @@ Codegen::Codegen(const std::string& moduleName) {
     doubleTy = Type::getDoubleTy(*context_);
     charPtrTy = Type::getInt8PtrTy(*context_);
     intPtrTy = Type::getInt32PtrTy(*context_);
-    arrayStructTy = GetPtrTy(StructType::get(*context_, {int32, intPtrTy}));
+    arrayStructTy = getMultiArrPtrTy(1, int32);
+
+    // Arrays that haven't been assigned yet are empty rather than null
+    emptyArray = new GlobalVariable(*module_, int64, true, GlobalValue::PrivateLinkage,
+                                    ConstantInt::get(int64, 0), "emptyArray");
 
     declareExternFunction("printString", voidTy, {charPtrTy});
     declareExternFunction("printInt", voidTy, {int32});
@@ -25,13 +46,43 @@ Codegen::Codegen(const std::string& moduleName) {
     declareExternFunction("readDouble", doubleTy, {});
     declareExternFunction("readInt", int32, {});
     declareExternFunction("multiArray", arrayStructTy, {int32, int32, intPtrTy});
+    env_->findFn("multiArray")->addRetAttr(
+        Attribute::getWithDereferenceableBytes(*context_, 4));
+    declareExternFunction("indexOutOfBounds", voidTy, {int32, int32});
+    env_->findFn("indexOutOfBounds")->setDoesNotReturn();
 }
 
 void Codegen::run(bnfc::Prog* p) {
+    run(p, 0, static_cast<bnfc::Program*>(p)->listtopdef_->size());
+}
+
+void Codegen::run(bnfc::Prog* p, std::size_t first, std::size_t last) {
     ProgramBuilder builder(*this);
-    builder.Visit(p);
-    for (auto& fn : module_->functions())
-        removeUnreachableCode(fn);
+    builder.build(static_cast<bnfc::Program*>(p), first, last);
+    // The runtime functions are all declared up front, only the called ones are kept
+    for (auto& fn : make_early_inc_range(module_->functions())) {
+        if (!fn.isDeclaration())
+            simplifyCFG(fn);
+        else if (fn.use_empty())
+            fn.eraseFromParent();
+    }
+}
+
+void Codegen::link(Codegen& other) {
+    TimeTraceScope trace("Link module", other.module_->getName());
+    SmallVector<char, 0> bitcode;
+    raw_svector_ostream bitcodeStream(bitcode);
+    WriteBitcodeToFile(*other.module_, bitcodeStream);
+    other.module_.reset();
+
+    Expected<std::unique_ptr<Module>> copy = parseBitcodeFile(
+        MemoryBufferRef(StringRef(bitcode.data(), bitcode.size()), "part"), *context_);
+    if (!copy)
+        throw std::runtime_error("ERROR: Could not read part of the module: " +
+                                 toString(copy.takeError()));
+    // A function built in the other part replaces its declaration here
+    if (Linker::linkModules(*module_, std::move(*copy)))
+        throw std::runtime_error("ERROR: Could not link the parts of the module");
 }
 
 BasicBlock* Codegen::newBasicBlock() {
@@ -39,6 +90,64 @@ BasicBlock* Codegen::newBasicBlock() {
                                     env_->getCurrentFn());
 }
 
+void Codegen::enterBlock(BasicBlock* bb, bool seal) {
+    builder_->SetInsertPoint(bb);
+    if (seal)
+        env_->sealBlock(bb);
+}
+
+void Codegen::declareVar(const std::string& ident, Type* type, Value* value) {
+    // Arrays are the only variables of pointer type
+    if (options_.gcRoots && type->isPointerTy()) {
+        Value* root = newRoot(type);
+        builder_->CreateStore(value, root);
+        env_->addVar(ident, type, root);
+        return;
+    }
+    env_->writeVar(env_->addVar(ident, type), builder_->GetInsertBlock(), value);
+}
+
+Value* Codegen::loadVar(const std::string& ident) {
+    const Variable& var = env_->findVar(ident);
+    if (var.slot)
+        return builder_->CreateLoad(var.type, var.slot);
+    return env_->readVar(var, builder_->GetInsertBlock());
+}
+
+void Codegen::storeVar(const std::string& ident, Value* value) {
+    const Variable& var = env_->findVar(ident);
+    if (var.slot)
+        builder_->CreateStore(value, var.slot);
+    else
+        env_->writeVar(var, builder_->GetInsertBlock(), value);
+}
+
+AllocaInst* Codegen::newEntryAlloca(Type* type) {
+    BasicBlock& entry = env_->getCurrentFn()->getEntryBlock();
+    IRBuilder<> atEntry(&entry, entry.begin());
+    return atEntry.CreateAlloca(type);
+}
+
+Value* Codegen::newRoot(Type* type) {
+    AllocaInst* var = newEntryAlloca(type);
+    IRBuilder<> atEntry(var->getParent(), std::next(var->getIterator()));
+    atEntry.CreateCall(Intrinsic::getDeclaration(module_.get(), Intrinsic::gcroot),
+                       {atEntry.CreatePointerCast(var, PointerType::getUnqual(charPtrTy)),
+                        ConstantPointerNull::get((PointerType*)charPtrTy)});
+    atEntry.CreateStore(ConstantPointerNull::get((PointerType*)type), var);
+    return var;
+}
+
+Value* Codegen::loadLength(Value* array) {
+    array = builder_->CreatePointerCast(array, arrayStructTy);
+    Value* lengthPtr = builder_->CreateInBoundsGEP(
+        arrayStructTy->getPointerElementType(), array,
+        {ConstantInt::get(int32, 0), ConstantInt::get(int32, 0)});
+    LoadInst* length = builder_->CreateLoad(int32, lengthPtr);
+    length->setMetadata(LLVMContext::MD_invariant_load, MDNode::get(*context_, {}));
+    return length;
+}
+
 void Codegen::declareExternFunction(const std::string& ident, Type* retType,
                                     ArrayRef<Type*> paramTypes,
                                     bool isVariadic) {
@@ -48,31 +157,76 @@ void Codegen::declareExternFunction(const std::string& ident, Type* retType,
     env_->addSignature(ident, fn);
 }
 
-// Removes "unreachables" and the instructions that follow.
-// Also removes empty BasicBlocks
-void Codegen::removeUnreachableCode(Function& fn) {
-    auto bb = fn.begin();
-    while (bb != fn.end()) {
-        bool unreachable = false;
-        auto instr = bb->begin();
-        while (instr != bb->end()) {
-            if (instr->getOpcode() == 7) // unreachable
-                unreachable = true;
-            instr = unreachable ? instr->eraseFromParent() : std::next(instr);
+Function* Codegen::declareFunction(const std::string& ident, bnfc::Type* retType,
+                                   const std::list<bnfc::Type*>& argTypes) {
+    std::vector<Type*> paramTypes;
+    for (bnfc::Type* argType : argTypes)
+        paramTypes.push_back(getLlvmType(argType, *this));
+    declareExternFunction(ident, getLlvmType(retType, *this), paramTypes);
+
+    // Arrays are never null, their length can always be read (see emptyArray)
+    Function* fn = env_->findFn(ident);
+    for (unsigned i = 0; i < paramTypes.size(); i++)
+        if (paramTypes[i]->isPointerTy())
+            fn->addDereferenceableParamAttr(i, 4);
+    if (fn->getReturnType()->isPointerTy())
+        fn->addRetAttr(Attribute::getWithDereferenceableBytes(*context_, 4));
+    return fn;
+}
+
+// The blocks are built straight from the statements, which leaves blocks that only
+// jump on, branches on constants (while (true)) and code after a return.
+void Codegen::simplifyCFG(Function& fn) {
+    TimeTraceScope trace("Simplify CFG", fn.getName());
+    for (BasicBlock& bb : fn) {
+        // The end of a non-void function that always returns before
+        if (!bb.getTerminator())
+            new UnreachableInst(fn.getContext(), &bb);
+        ConstantFoldTerminator(&bb, true);
+    }
+    // Also the blocks following a return, which have no predecessors
+    removeUnreachableBlocks(fn);
+    for (BasicBlock& bb : make_early_inc_range(fn)) {
+        if (MergeBlockIntoPredecessor(&bb))
+            continue;
+        // Blocks that only jump on, e.g. the end of an if-statement without else
+        auto* br = dyn_cast<BranchInst>(bb.getTerminator());
+        if (br && br->isUnconditional() && bb.getFirstNonPHIOrDbg() == br &&
+            &bb != &fn.getEntryBlock())
+            TryToSimplifyUncondBranchFromEmptyBlock(&bb);
+    }
+}
+
+std::unique_ptr<TargetMachine> Codegen::createHostTargetMachine() {
+    InitializeNativeTarget();
+    InitializeNativeTargetAsmPrinter();
+
+    std::string triple = sys::getDefaultTargetTriple();
+    std::string error;
+    const Target* target = TargetRegistry::lookupTarget(triple, error);
+    if (!target)
+        throw std::runtime_error("ERROR: " + error);
+
+    std::string features;
+    StringMap<bool> hostFeatures;
+    if (sys::getHostCPUFeatures(hostFeatures)) {
+        for (auto& feature : hostFeatures) {
+            features += features.empty() ? "" : ",";
+            features += (feature.second ? "+" : "-") + feature.first().str();
         }
-        bb = bb->empty() ? bb->eraseFromParent() : std::next(bb);
     }
+
+    return std::unique_ptr<TargetMachine>(
+        target->createTargetMachine(triple, sys::getHostCPUName(), features,
+                                    TargetOptions(), Reloc::PIC_));
 }
 
 // Returns a pointer to a multidimensional array with 'dim' dimensions and type 't'.
+// An array is its length followed by the elements: { i32, [0 x T] }. The elements
+// of an outer dimension are pointers to the arrays of its rows.
 Type* Codegen::getMultiArrPtrTy(std::size_t dim, Type* t) {
-
-    if (dim == 1) {
-        auto ptrTy = GetPtrTy(ArrayType::get(t, 0));
-        return GetPtrTy(StructType::get(*context_, {int32, ptrTy}));
-    }
-    auto ptrTy = GetPtrTy(ArrayType::get(getMultiArrPtrTy(dim - 1, t), 0));
-    return GetPtrTy(StructType::get(*context_, {int32, ptrTy}));
+    Type* elementTy = dim == 1 ? t : getMultiArrPtrTy(dim - 1, t);
+    return GetPtrTy(StructType::get(*context_, {int32, ArrayType::get(elementTy, 0)}));
 }
 
 } // namespace jlc::codegen
@@ -2,9 +2,12 @@
 #include "CodegenEnv.h"
 #include "bnfc/Absyn.H"
 #include "src/Common/BaseVisitor.h"
+#include "src/Common/NodeKind.h"
 #include "src/Common/Util.h"
 #include "llvm/IR/IRBuilder.h"
+#include "llvm/Target/TargetMachine.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include <list>
 
 namespace jlc::codegen {
 
@@ -30,34 +33,79 @@ auto GetPtrTy(Args&&... args)
 #define INT1_TY parent_.int1
 #define ARR_STRUCT_TY parent_.arrayStructTy
 
+// What the generated code does on top of the program itself
+struct CodegenOptions {
+    // --gc, array variables are roots of a shadow stack for lib/gc.c
+    bool gcRoots = false;
+    // --bounds-check, each array index is checked against the length
+    bool boundsChecks = false;
+};
+
 class Codegen {
   public:
-    Codegen(const std::string& moduleName = std::string());
+    Codegen(const std::string& moduleName = std::string(), CodegenOptions options = {});
 
     // Entry point of codegen!
     void run(bnfc::Prog* p);
+    // Builds part of the program, the functions first to last (exclusive), and only
+    // declares the others. The parts are built independently, e.g. each on a thread
+    // with a Codegen of its own, and then linked together.
+    void run(bnfc::Prog* p, std::size_t first, std::size_t last);
+    // Moves the functions of another part into this module. Each Codegen has a context
+    // of its own, so the other module is copied through bitcode, and other is empty
+    // afterwards.
+    void link(Codegen& other);
+    // Declares a Javalette function, such as one of another module that the program
+    // calls (see Frontend/Interface.h) before run.
+    Function* declareFunction(const std::string& ident, bnfc::Type* retType,
+                              const std::list<bnfc::Type*>& argTypes);
     Module& getModuleRef() { return *module_; }
+    TargetMachine& getTargetMachineRef() { return *targetMachine_; }
 
   private:
     // These visitors need access to the codegen-environment and are therefore friends.
     friend class ProgramBuilder;
     friend class FunctionAdder;
     friend class DeclBuilder;
-    friend class TypeEncoder;
-    friend class DefaultValue;
+    friend Type* getLlvmType(bnfc::Type* p, Codegen& parent);
+    friend Value* getDefaultVal(bnfc::Type* p, Codegen& parent);
     friend class BinOpBuilder;
     friend class ExpBuilder;
     friend class IndexBuilder;
+    friend class CondBuilder;
     friend class AssignmentBuilder;
+    friend class JitRunner;
 
     BasicBlock* newBasicBlock();
+    // Continues building in the block, and seals it (see Env::sealBlock). All the
+    // branches to it must be built by then, so loop headers are sealed later instead.
+    void enterBlock(BasicBlock* bb, bool seal = true);
+
+    // The local variables of the current function are registers in SSA form, built
+    // by Env. With gcRoots an array variable is a root of the shadow stack instead,
+    // allocated in the entry block and null until it is assigned.
+    void declareVar(const std::string& ident, Type* type, Value* value);
+    Value* loadVar(const std::string& ident);
+    void storeVar(const std::string& ident, Value* value);
+    Value* newRoot(Type* type);
+    // Stack memory of the current function. The allocas all go in the entry block, so
+    // that the frame has a fixed size and a loop doesn't grow the stack each iteration.
+    AllocaInst* newEntryAlloca(Type* type);
+    // Loads the length of an array. The length never changes after the runtime has
+    // allocated the array, so the load is marked invariant for LLVM to hoist and merge.
+    Value* loadLength(Value* array);
     void declareExternFunction(const std::string& ident, Type* retType,
                                ArrayRef<Type*> paramTypes, bool isVariadic = false);
 
-    // Removes "unreachables" and the instructions that follow.
-    // Also removes empty BasicBlocks
-    static void removeUnreachableCode(Function& fn);
+    // Removes the blocks that are never reached, folds constant branches and merges
+    // the blocks that just follow each other.
+    static void simplifyCFG(Function& fn);
 
+    // Describes the host, the module gets its triple and data layout from it.
+    static std::unique_ptr<TargetMachine> createHostTargetMachine();
+
+    CodegenOptions options_;
+    std::unique_ptr<TargetMachine> targetMachine_;
     std::unique_ptr<Env> env_;
     std::unique_ptr<IRBuilder<>> builder_;
     std::unique_ptr<LLVMContext> context_;
@@ -72,83 +120,57 @@ class Codegen {
     Type* charPtrTy;
     Type* intPtrTy;
     Type* arrayStructTy;
+    GlobalVariable* emptyArray; // The default value of arrays, with length 0
     Type* getMultiArrPtrTy(std::size_t dim, Type* t);
 };
 
 // Helper classes & functions
 // ------------------------------------------------------------
 
-// Returns the llvm-equivalent (Type*) from a bnfc::Type*
-class TypeEncoder : public ValueVisitor<Type*> {
-  public:
-    TypeEncoder(Codegen& parent) : parent_(parent) {}
-
-    void visitInt(bnfc::Int* p) override { Return(parent_.int32); }
-    void visitDoub(bnfc::Doub* p) override { Return(parent_.doubleTy); }
-    void visitBool(bnfc::Bool* p) override { Return(parent_.int1); }
-    void visitVoid(bnfc::Void* p) override { Return(parent_.voidTy); }
-    void visitStringLit(bnfc::StringLit* p) override { Return(parent_.int8); }
-    void visitArr(bnfc::Arr* p) override {
-        Return(parent_.getMultiArrPtrTy(p->listdim_->size(), Visit(p->type_)));
-    }
+// These switch on the kind tag of the node (see NodeKind.h)
 
-  private:
-    Codegen& parent_;
-};
-
-// Returns the default value for each type
-class DefaultValue : public ValueVisitor<Constant*> {
-  public:
-    DefaultValue(Codegen& parent) : parent_(parent) {}
-
-    void visitBool(bnfc::Bool* p) override { Return(ConstantInt::get(parent_.int1, 0)); }
-    void visitInt(bnfc::Int* p) override { Return(ConstantInt::get(parent_.int32, 0)); }
-    void visitDoub(bnfc::Doub* p) override {
-        Return(ConstantFP::get(parent_.doubleTy, 0.0));
+// Returns the llvm-equivalent (Type*) from a bnfc::Type*
+inline Type* getLlvmType(bnfc::Type* p, Codegen& parent) {
+    switch (kindOf(p)) {
+    case NodeKind::Int: return parent.int32;
+    case NodeKind::Doub: return parent.doubleTy;
+    case NodeKind::Bool: return parent.int1;
+    case NodeKind::Void: return parent.voidTy;
+    case NodeKind::StringLit: return parent.int8;
+    case NodeKind::Arr: {
+        auto arr = static_cast<bnfc::Arr*>(p);
+        return parent.getMultiArrPtrTy(arr->listdim_->size(),
+                                       getLlvmType(arr->type_, parent));
     }
-    void visitArr(bnfc::Arr* p) override {
-        TypeEncoder typeEncoder(parent_);
-        auto structPtr = (PointerType*)parent_.getMultiArrPtrTy(
-            p->listdim_->size(), typeEncoder.Visit(p->type_));
-        Return(ConstantPointerNull::get(structPtr));
+    default: return nullptr;
     }
-
-  private:
-    Codegen& parent_;
-};
+}
 
 // Returns the size value for each type
-class TypeSize : public ValueVisitor<std::size_t> {
-  public:
-    TypeSize(Codegen& parent) : parent_(parent) {}
-
-    void visitBool(bnfc::Bool* p) override { Return(4); }
-    void visitInt(bnfc::Int* p) override { Return(4); }
-    void visitDoub(bnfc::Doub* p) override { Return(8); }
-
-  private:
-    Codegen& parent_;
-};
-
 inline std::size_t getTypeSize(bnfc::Type* p, Codegen& parent) {
-    TypeSize typeSize(parent);
-    return typeSize.Visit(p);
-}
-
-inline Type* getLlvmType(bnfc::Type* p, Codegen& parent) {
-    TypeEncoder typeEncoder(parent);
-    return typeEncoder.Visit(p);
+    switch (kindOf(p)) {
+    case NodeKind::Bool: return 4;
+    case NodeKind::Int: return 4;
+    case NodeKind::Doub: return 8;
+    default: return 0;
+    }
 }
 
+// Returns the default value for each type
 inline Value* getDefaultVal(bnfc::Type* p, Codegen& parent) {
-    DefaultValue defaultValue(parent);
-    return defaultValue.Visit(p);
+    switch (kindOf(p)) {
+    case NodeKind::Bool: return ConstantInt::get(parent.int1, 0);
+    case NodeKind::Int: return ConstantInt::get(parent.int32, 0);
+    case NodeKind::Doub: return ConstantFP::get(parent.doubleTy, 0.0);
+    case NodeKind::Arr:
+        return ConstantExpr::getPointerCast(parent.emptyArray, getLlvmType(p, parent));
+    default: return nullptr;
+    }
 }
 
 inline bnfc::Type* getBNFCType(bnfc::Visitable* exp) {
-    auto eTyped = dynamic_cast<bnfc::ETyped*>(exp);
-    JLC_ASSERT(eTyped, "Expr not typed!");
-    return eTyped->type_;
+    JLC_ASSERT(kindOf(exp) == NodeKind::ETyped, "Expr not typed!");
+    return static_cast<bnfc::ETyped*>(exp)->type_;
 }
 
 } // namespace jlc::codegen
\ No newline at end of file
@@ -1,19 +1,18 @@
 #include "CodegenEnv.h"
+#include "llvm/IR/CFG.h"
 
 namespace jlc::codegen {
 
-Env::Env() : scopes_(), signatures_(), labelNr_(0) {}
+Env::Env() : scopes_(), signatures_(), currentFn_(nullptr), labelNr_(0) {}
 
 void Env::addSignature(const std::string& fnName, llvm::Function* fn) {
     if (auto [_, success] = signatures_.insert({fnName, fn}); !success)
         throw std::runtime_error("ERROR: Failed to add signature '" + fnName + "'");
 }
 
-llvm::Value* Env::findVar(const std::string& ident) {
-    for (auto& scope : scopes_) {
-        if (auto var = map::getValue(ident, scope))
-            return *var;
-    }
+const Variable& Env::findVar(const std::string& ident) {
+    if (const unsigned* var = scopes_.find(symbols_.intern(ident)))
+        return vars_[*var];
     throw std::runtime_error("ERROR: Variable '" + ident + "' not found in LLVM-CodeGen");
 }
 // Called when a function call is invoked, throws if the function doesn't exist.
@@ -23,10 +22,105 @@ llvm::Function* Env::findFn(const std::string& fn) {
     throw std::runtime_error("ERROR: Function '" + fn + "' not found in LLVM-CodeGen");
 }
 // Adds a variable to the current scope, throws if it already exists.
-void Env::addVar(const std::string& ident, llvm::Value* v) {
-    Scope& currentScope = scopes_.front();
-    if (auto [_, success] = currentScope.insert({ident, v}); !success)
+const Variable& Env::addVar(const std::string& ident, llvm::Type* type,
+                            llvm::Value* slot) {
+    unsigned id = vars_.size();
+    if (!scopes_.add(symbols_.intern(ident), id))
         throw std::runtime_error("ERROR: Failed to add var '" + ident + "'");
+    return vars_.emplace_back(Variable{ident, type, slot, id});
+}
+
+void Env::setCurrentFn(llvm::Function* fn) {
+    currentFn_ = fn;
+    vars_.clear();
+    currentDef_.clear();
+    incompletePhis_.clear();
+    sealed_.clear();
+}
+
+void Env::writeVar(const Variable& var, llvm::BasicBlock* bb, llvm::Value* value) {
+    currentDef_[{var.id, bb}] = value;
+}
+
+llvm::Value* Env::readVar(const Variable& var, llvm::BasicBlock* bb) {
+    auto def = currentDef_.find({var.id, bb});
+    if (def != currentDef_.end())
+        return def->second;
+    return readVarRecursive(var, bb);
+}
+
+// The phis go first in the block, before the code already built there
+static llvm::PHINode* newPhi(const Variable& var, llvm::BasicBlock* bb) {
+    if (bb->empty())
+        return llvm::PHINode::Create(var.type, 0, var.name, bb);
+    return llvm::PHINode::Create(var.type, 0, var.name, &bb->front());
+}
+
+llvm::Value* Env::readVarRecursive(const Variable& var, llvm::BasicBlock* bb) {
+    llvm::Value* value;
+    if (!sealed_.count(bb)) {
+        // Not all predecessors are known yet
+        llvm::PHINode* phi = newPhi(var, bb);
+        incompletePhis_[bb].emplace_back(var.id, phi);
+        value = phi;
+    } else if (llvm::BasicBlock* pred = bb->getSinglePredecessor()) {
+        value = readVar(var, pred);
+    } else if (llvm::pred_empty(bb)) {
+        // Only in code that is never reached, as variables are initialized
+        value = llvm::PoisonValue::get(var.type);
+    } else {
+        // The phi breaks cycles through loops
+        llvm::PHINode* phi = newPhi(var, bb);
+        writeVar(var, bb, phi);
+        value = addPhiOperands(var, phi);
+    }
+    writeVar(var, bb, value);
+    return value;
+}
+
+llvm::Value* Env::addPhiOperands(const Variable& var, llvm::PHINode* phi) {
+    for (llvm::BasicBlock* pred : llvm::predecessors(phi->getParent()))
+        phi->addIncoming(readVar(var, pred), pred);
+    return tryRemoveTrivialPhi(phi);
+}
+
+// A phi that only merges one value (and itself) is replaced by that value
+llvm::Value* Env::tryRemoveTrivialPhi(llvm::PHINode* phi) {
+    llvm::Value* same = nullptr;
+    for (llvm::Value* op : phi->incoming_values()) {
+        if (op == same || op == phi)
+            continue;
+        if (same)
+            return phi;
+        same = op;
+    }
+    if (!same)
+        same = llvm::PoisonValue::get(phi->getType());
+
+    // Replacing the phi may make the phis using it trivial as well
+    std::vector<llvm::WeakVH> users;
+    for (llvm::User* user : phi->users())
+        if (user != phi && llvm::isa<llvm::PHINode>(user))
+            users.emplace_back(user);
+    phi->replaceAllUsesWith(same);
+    phi->eraseFromParent();
+    for (llvm::WeakVH& user : users)
+        if (user)
+            tryRemoveTrivialPhi(llvm::cast<llvm::PHINode>(user));
+    return same;
+}
+
+void Env::sealBlock(llvm::BasicBlock* bb) {
+    // Sealed first, so that reading other variables here while completing the phis
+    // adds complete phis right away
+    sealed_.insert(bb);
+    auto incomplete = incompletePhis_.find(bb);
+    if (incomplete == incompletePhis_.end())
+        return;
+    std::vector<std::pair<unsigned, llvm::PHINode*>> phis = std::move(incomplete->second);
+    incompletePhis_.erase(incomplete);
+    for (auto [id, phi] : phis)
+        addPhiOperands(vars_[id], phi);
 }
 
-} // namespace jlc::codegen
\ No newline at end of file
+} // namespace jlc::codegen
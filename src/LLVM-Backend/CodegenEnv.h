@@ -1,40 +1,76 @@
 #pragma once
+#include "src/Common/SymbolTable.h"
 #include "src/Common/Util.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/ValueHandle.h"
 #include <iostream>
 #include <list>
 
 namespace jlc::codegen {
 
+// A local variable of the current function. Its value is tracked in SSA form, unless
+// it has a stack slot (the roots of --gc), in which case it lives in memory.
+struct Variable {
+    std::string name;
+    llvm::Type* type;
+    llvm::Value* slot;
+    unsigned id;
+};
+
 // Defines the environment for generating IR Code
 class Env {
-    using Scope = std::unordered_map<std::string, llvm::Value*>;
-
   public:
     Env();
 
     // To separate local variables
-    void enterScope() { scopes_.push_front(Scope()); }
-    void exitScope() { scopes_.pop_front(); }
+    void enterScope() { scopes_.enterScope(); }
+    void exitScope() { scopes_.exitScope(); }
 
     // Called in the first pass
     void addSignature(const std::string& fnName, llvm::Function* fn);
 
-    llvm::Value* findVar(const std::string& ident);
+    // Throws if the variable doesn't exist.
+    const Variable& findVar(const std::string& ident);
     // Called when a function call is invoked, throws if the function doesn't exist.
     llvm::Function* findFn(const std::string& fn);
     // Adds a variable to the current scope, throws if it already exists.
-    void addVar(const std::string& ident, llvm::Value* v);
+    const Variable& addVar(const std::string& ident, llvm::Type* type,
+                           llvm::Value* slot = nullptr);
 
-    void setCurrentFn(llvm::Function* fn) { currentFn_ = fn; }
+    // SSA construction as in Braun et al., "Simple and Efficient Construction of
+    // Static Single Assignment Form". The value of a variable at the end of a block
+    // is its last write there, or else comes from the predecessors, through a phi if
+    // they disagree. A block must be sealed once all branches to it are built, which
+    // completes the phis it got while its predecessors were unknown (loop headers).
+    void writeVar(const Variable& var, llvm::BasicBlock* bb, llvm::Value* value);
+    llvm::Value* readVar(const Variable& var, llvm::BasicBlock* bb);
+    void sealBlock(llvm::BasicBlock* bb);
+
+    // Also starts over with the variables and SSA state of the function
+    void setCurrentFn(llvm::Function* fn);
     llvm::Function* getCurrentFn() { return currentFn_; }
     std::string getNextLabel() { return "label_" + std::to_string(labelNr_++); }
 
   private:
-    std::list<Scope> scopes_;
+    llvm::Value* readVarRecursive(const Variable& var, llvm::BasicBlock* bb);
+    llvm::Value* addPhiOperands(const Variable& var, llvm::PHINode* phi);
+    llvm::Value* tryRemoveTrivialPhi(llvm::PHINode* phi);
+
+    SymbolTable symbols_;
+    ScopeTable<unsigned> scopes_; // Var -> index into vars_
+    std::vector<Variable> vars_;
     std::unordered_map<std::string, llvm::Function*> signatures_;
     llvm::Function* currentFn_;
     int labelNr_;
+
+    // The handles follow phis that are replaced by their only value
+    llvm::DenseMap<std::pair<unsigned, llvm::BasicBlock*>, llvm::WeakTrackingVH>
+        currentDef_;
+    llvm::DenseMap<llvm::BasicBlock*, std::vector<std::pair<unsigned, llvm::PHINode*>>>
+        incompletePhis_;
+    llvm::DenseSet<llvm::BasicBlock*> sealed_;
 };
 
-} // namespace jlc::codegen
\ No newline at end of file
+} // namespace jlc::codegen
@@ -0,0 +1,75 @@
+#include "CondBuilder.h"
+#include "ExpBuilder.h"
+
+namespace jlc::codegen {
+
+CondBuilder::CondBuilder(Codegen& parent) : parent_(parent) {}
+
+void CondBuilder::branch(bnfc::Expr* p, BasicBlock* onTrue, BasicBlock* onFalse) {
+    switch (kindOf(p)) {
+    case NodeKind::ETyped:
+        return branch(static_cast<bnfc::ETyped*>(p)->expr_, onTrue, onFalse);
+    case NodeKind::Not:
+        return branch(static_cast<bnfc::Not*>(p)->expr_, onFalse, onTrue);
+    case NodeKind::EAnd: {
+        auto e = static_cast<bnfc::EAnd*>(p);
+        BasicBlock* evalSecond = parent_.newBasicBlock();
+        evalSecond->moveBefore(onTrue); // Falls through at -O0
+        branch(e->expr_1, evalSecond, onFalse);
+        parent_.enterBlock(evalSecond);
+        return branch(e->expr_2, onTrue, onFalse);
+    }
+    case NodeKind::EOr: {
+        auto e = static_cast<bnfc::EOr*>(p);
+        BasicBlock* evalSecond = parent_.newBasicBlock();
+        evalSecond->moveBefore(onTrue);
+        branch(e->expr_1, onTrue, evalSecond);
+        parent_.enterBlock(evalSecond);
+        return branch(e->expr_2, onTrue, onFalse);
+    }
+    default: {
+        ExpBuilder expBuilder(parent_);
+        B->CreateCondBr(expBuilder.Visit(p), onTrue, onFalse);
+    }
+    }
+}
+
+bool CondBuilder::isSpeculatable(bnfc::Expr* p) {
+    switch (kindOf(p)) {
+    case NodeKind::ELitInt:
+    case NodeKind::ELitDoub:
+    case NodeKind::ELitTrue:
+    case NodeKind::ELitFalse:
+    case NodeKind::EVar: return true;
+    // Arrays are never null, so the length is always there
+    case NodeKind::EArrLen: return isSpeculatable(static_cast<bnfc::EArrLen*>(p)->expr_);
+    case NodeKind::ETyped: return isSpeculatable(static_cast<bnfc::ETyped*>(p)->expr_);
+    case NodeKind::Not: return isSpeculatable(static_cast<bnfc::Not*>(p)->expr_);
+    case NodeKind::Neg: return isSpeculatable(static_cast<bnfc::Neg*>(p)->expr_);
+    case NodeKind::EAdd: {
+        auto e = static_cast<bnfc::EAdd*>(p);
+        return isSpeculatable(e->expr_1) && isSpeculatable(e->expr_2);
+    }
+    case NodeKind::EMul: { // Division by zero traps
+        auto e = static_cast<bnfc::EMul*>(p);
+        return kindOf(e->mulop_) == NodeKind::Times && isSpeculatable(e->expr_1) &&
+               isSpeculatable(e->expr_2);
+    }
+    case NodeKind::ERel: {
+        auto e = static_cast<bnfc::ERel*>(p);
+        return isSpeculatable(e->expr_1) && isSpeculatable(e->expr_2);
+    }
+    case NodeKind::EAnd: {
+        auto e = static_cast<bnfc::EAnd*>(p);
+        return isSpeculatable(e->expr_1) && isSpeculatable(e->expr_2);
+    }
+    case NodeKind::EOr: {
+        auto e = static_cast<bnfc::EOr*>(p);
+        return isSpeculatable(e->expr_1) && isSpeculatable(e->expr_2);
+    }
+    // Calls, indexing (out of bounds) and new arrays
+    default: return false;
+    }
+}
+
+} // namespace jlc::codegen
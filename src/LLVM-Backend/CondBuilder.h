@@ -0,0 +1,25 @@
+#pragma once
+#include "CodeGen.h"
+
+namespace jlc::codegen {
+
+using namespace llvm;
+
+// Used to branch on a boolean expression
+// && and || and ! become branches to the targets, so the conditions of if and while
+// jump straight to where they lead instead of computing a boolean first.
+class CondBuilder {
+  public:
+    CondBuilder(Codegen& parent);
+    void branch(bnfc::Expr* p, BasicBlock* onTrue, BasicBlock* onFalse);
+
+    // True if the expression can be evaluated even when the program wouldn't, as it
+    // has no side effects and can't trap. Then && and || can evaluate both operands
+    // and select instead of branching.
+    static bool isSpeculatable(bnfc::Expr* p);
+
+  private:
+    Codegen& parent_;
+};
+
+} // namespace jlc::codegen
@@ -1,5 +1,6 @@
 #include "ExpBuilder.h"
 #include "BinOpBuilder.h"
+#include "CondBuilder.h"
 #include "IndexBuilder.h"
 
 namespace jlc::codegen {
@@ -42,10 +43,7 @@ void ExpBuilder::visitEApp(bnfc::EApp* p) {
     Return(B->CreateCall(fn, args));
 }
 
-void ExpBuilder::visitEVar(bnfc::EVar* p) {
-    Value* varPtr = ENV->findVar(p->ident_);
-    Return(B->CreateLoad(varPtr));
-}
+void ExpBuilder::visitEVar(bnfc::EVar* p) { Return(parent_.loadVar(p->ident_)); }
 
 void ExpBuilder::visitEMul(bnfc::EMul* p) {
     BinOpBuilder binOpBuilder(parent_, p->expr_1, p->expr_2);
@@ -60,65 +58,60 @@ void ExpBuilder::visitEAdd(bnfc::EAdd* p) {
     Return(binOpBuilder.Visit(p->addop_));
 }
 
+// The second operand is only evaluated when the first one doesn't decide the result,
+// so the result is a phi of the blocks that decided it. A cheap second operand
+// without side effects is evaluated anyway, and selected from.
 void ExpBuilder::visitEAnd(bnfc::EAnd* p) {
-    BasicBlock* contBlock = parent_.newBasicBlock();
+    if (CondBuilder::isSpeculatable(p->expr_2)) {
+        Value* e1 = Visit(p->expr_1);
+        Return(B->CreateLogicalAnd(e1, Visit(p->expr_2)));
+        return;
+    }
     BasicBlock* evalSecond = parent_.newBasicBlock();
-    BasicBlock* secondTrue = parent_.newBasicBlock();
-
-    // Store false by default
-    Value* result = B->CreateAlloca(parent_.int1);
-    B->CreateStore(INT1(0), result);
+    BasicBlock* contBlock = parent_.newBasicBlock();
 
-    // Evaluate expr 1
+    // False if expr 1 is false
     Value* e1 = Visit(p->expr_1);
-    Value* e1True = B->CreateICmpEQ(e1, INT1(1));
-    B->CreateCondBr(e1True, evalSecond, contBlock);
+    BasicBlock* firstBlock = B->GetInsertBlock();
+    B->CreateCondBr(e1, evalSecond, contBlock);
 
-    // Evaluate expr 2
-    B->SetInsertPoint(evalSecond);
+    // Else expr 2
+    parent_.enterBlock(evalSecond);
     Value* e2 = Visit(p->expr_2);
-    Value* e2True = B->CreateICmpEQ(e2, INT1(1));
-    B->CreateCondBr(e2True, secondTrue, contBlock);
-
-    // Store true if both true
-    B->SetInsertPoint(secondTrue);
-    B->CreateStore(INT1(1), result);
+    BasicBlock* secondBlock = B->GetInsertBlock();
     B->CreateBr(contBlock);
 
-    // Finally, load result for usage in statement
-    B->SetInsertPoint(contBlock);
-    result = B->CreateLoad(parent_.int1, result);
+    parent_.enterBlock(contBlock);
+    PHINode* result = B->CreatePHI(INT1_TY, 2);
+    result->addIncoming(INT1(0), firstBlock);
+    result->addIncoming(e2, secondBlock);
     Return(result);
 }
 
 void ExpBuilder::visitEOr(bnfc::EOr* p) {
-    BasicBlock* contBlock = parent_.newBasicBlock();
+    if (CondBuilder::isSpeculatable(p->expr_2)) {
+        Value* e1 = Visit(p->expr_1);
+        Return(B->CreateLogicalOr(e1, Visit(p->expr_2)));
+        return;
+    }
     BasicBlock* evalSecond = parent_.newBasicBlock();
-    BasicBlock* secondFalse = parent_.newBasicBlock();
-
-    // Store true by default
-    Value* result = B->CreateAlloca(parent_.int1);
-    B->CreateStore(INT1(1), result);
+    BasicBlock* contBlock = parent_.newBasicBlock();
 
-    // Evaluate expr 1
+    // True if expr 1 is true
     Value* e1 = Visit(p->expr_1);
-    Value* e1True = B->CreateICmpEQ(e1, INT1(1));
-    B->CreateCondBr(e1True, contBlock, evalSecond);
+    BasicBlock* firstBlock = B->GetInsertBlock();
+    B->CreateCondBr(e1, contBlock, evalSecond);
 
-    // Evaluate expr 2
-    B->SetInsertPoint(evalSecond);
+    // Else expr 2
+    parent_.enterBlock(evalSecond);
     Value* e2 = Visit(p->expr_2);
-    Value* e2True = B->CreateICmpEQ(e2, INT1(1));
-    B->CreateCondBr(e2True, contBlock, secondFalse);
-
-    // Store false if both false
-    B->SetInsertPoint(secondFalse);
-    B->CreateStore(INT1(0), result);
+    BasicBlock* secondBlock = B->GetInsertBlock();
     B->CreateBr(contBlock);
 
-    // Finally, load result for usage in statement
-    B->SetInsertPoint(contBlock);
-    result = B->CreateLoad(INT1_TY, result);
+    parent_.enterBlock(contBlock);
+    PHINode* result = B->CreatePHI(INT1_TY, 2);
+    result->addIncoming(INT1(1), firstBlock);
+    result->addIncoming(e2, secondBlock);
     Return(result);
 }
 void ExpBuilder::visitEIndex(bnfc::EIndex* p) {
@@ -127,32 +120,17 @@ void ExpBuilder::visitEIndex(bnfc::EIndex* p) {
     Return(load);
 }
 void ExpBuilder::visitEArrLen(bnfc::EArrLen* p) {
-    BasicBlock* hasLengthB = parent_.newBasicBlock();
-    BasicBlock* contB = parent_.newBasicBlock();
-    Value* temp = B->CreateAlloca(INT32_TY);
-    B->CreateStore(ZERO, temp); // Store 0 by default (0 length)
-    Value* array = Visit(p->expr_);
-    array = B->CreatePointerCast(array, ARR_STRUCT_TY);
-    Value* ptrDiff = B->CreatePtrDiff(
-        array, ConstantPointerNull::get((PointerType*)ARR_STRUCT_TY)); // zero if null
-    Value* cond = B->CreateICmpNE(ptrDiff, ConstantInt::get(INT64_TY, 0));
-    B->CreateCondBr(cond, hasLengthB, contB);
-    B->SetInsertPoint(hasLengthB);
-    Value* len =
-        B->CreateGEP(ARR_STRUCT_TY->getPointerElementType(), array, {ZERO, ZERO});
-    len = B->CreateLoad(INT32_TY, len);
-    B->CreateStore(len, temp);
-    B->CreateBr(contB);
-    B->SetInsertPoint(contB);
-    Return(B->CreateLoad(INT32_TY, temp));
+    // Unassigned arrays point to an empty array, so the length is always there
+    Return(parent_.loadLength(Visit(p->expr_)));
 }
 
 void ExpBuilder::visitEArrNew(bnfc::EArrNew* p) {
-    auto arrTy = dynamic_cast<bnfc::Arr*>(p->type_);
+    auto arrTy = kindOf(p->type_) == NodeKind::Arr ? static_cast<bnfc::Arr*>(p->type_)
+                                                   : nullptr;
     auto N = p->listexpdim_->size() + (arrTy ? arrTy->listdim_->size() : 0);
     auto arrayType = ArrayType::get(INT32_TY, N);
     Constant* typeSize = INT32(getTypeSize(arrTy ? arrTy->type_ : p->type_, parent_));
-    Value* dimList = B->CreateAlloca(arrayType);
+    Value* dimList = parent_.newEntryAlloca(arrayType);
 
     int i = 0;
     // Fill an array with the dimension sizes
@@ -1,3 +1,4 @@
+#include "llvm/IR/MDBuilder.h"
 
 #include "IndexBuilder.h"
 
@@ -5,26 +6,40 @@ namespace jlc::codegen {
 
 IndexBuilder::IndexBuilder(Codegen& parent) : parent_(parent) {}
 
+// The elements follow the length of the array, and the rows of a multi-dimensional
+// array are arrays of their own. So each index is a GEP, and each row one load.
 Value* IndexBuilder::indexArray(Value* base) {
-    int i = 1;
+    std::size_t i = 1;
     for (auto index : indices_) {
-        // Index struct
-        Value* ptrToArr =
-            B->CreateGEP(base->getType()->getPointerElementType(), base, {ZERO, ONE});
-        // Load ptr to array
-        base = B->CreateLoad(ptrToArr->getType()->getPointerElementType(), ptrToArr);
-        // Index array
-        base = B->CreateGEP(base->getType()->getPointerElementType(), base,
-                            {ZERO, index});
-        if(i == indices_.size())
+        if (parent_.options_.boundsChecks)
+            checkBounds(base, index);
+        Type* arrayTy = base->getType()->getPointerElementType();
+        base = B->CreateInBoundsGEP(arrayTy, base, {ZERO, ONE, index});
+        if (i == indices_.size())
             return base;
-        // Load the value
-        base = B->CreateLoad(base);
+        // Load the pointer to the row
+        base = B->CreateLoad(base->getType()->getPointerElementType(), base);
         ++i;
     }
     return base;
 }
 
+// One unsigned compare covers negative indices too. The checks that the optimizer
+// can prove to pass are removed again by BoundsCheckElimination.
+void IndexBuilder::checkBounds(Value* array, Value* index) {
+    Value* length = parent_.loadLength(array);
+    Value* inBounds = B->CreateICmpULT(index, length);
+    BasicBlock* ok = parent_.newBasicBlock();
+    BasicBlock* outOfBounds = parent_.newBasicBlock();
+    MDNode* weights = MDBuilder(*parent_.context_).createBranchWeights(1 << 20, 1);
+    B->CreateCondBr(inBounds, ok, outOfBounds, weights);
+
+    parent_.enterBlock(outOfBounds);
+    B->CreateCall(ENV->findFn("indexOutOfBounds"), {index, length});
+    B->CreateUnreachable();
+    parent_.enterBlock(ok);
+}
+
 void IndexBuilder::visitEIndex(bnfc::EIndex* p) {
     ExpBuilder expBuilder(parent_);
     Value* dimValue = expBuilder.Visit(p->expdim_);
@@ -16,6 +16,8 @@ class IndexBuilder : public ValueVisitor<Value*> {
 
     IndexBuilder(Codegen& parent);
     Value* indexArray(Value* base);
+    // Exits through the runtime unless 0 <= index < length (--bounds-check)
+    void checkBounds(Value* array, Value* index);
     void visitEIndex(bnfc::EIndex* p);
     void visitEArrNew(bnfc::EArrNew* p);
     void visitEVar(bnfc::EVar* p);
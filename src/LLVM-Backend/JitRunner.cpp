@@ -0,0 +1,260 @@
+// Included before CodeGen.h, whose builder macros (B, ENV, ...) clash with ORC
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/ExecutionEngine/Orc/CompileUtils.h"
+#include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
+#include "llvm/ExecutionEngine/Orc/IndirectionUtils.h"
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "JitRunner.h"
+#include "Optimizer.h"
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace jlc::codegen {
+
+using namespace llvm;
+
+static void throwOnError(Error error) {
+    if (error)
+        throw std::runtime_error("ERROR: JIT: " + toString(std::move(error)));
+}
+
+template <class T> static T throwOnError(Expected<T> value) {
+    throwOnError(value.takeError());
+    return std::move(*value);
+}
+
+// Recompiles hot functions at -O3 on a background thread.
+//
+// Every function F (except main) is called through an indirection stub named F. The
+// body is renamed to F.tier0 and counts its calls in the prologue; the call that
+// reaches the threshold queues F here. The worker compiles F.tier2 from the
+// unoptimized bitcode, with the other functions available for inlining, and swaps
+// the stub's pointer over to it. Calls already running in F.tier0 finish there.
+class TierUpCompiler {
+  public:
+    TierUpCompiler(orc::LLJIT& jit, orc::IndirectStubsManager& stubs,
+                   SmallVector<char, 0> bitcode, std::vector<std::string> functions)
+        : jit_(jit), stubs_(stubs), bitcode_(std::move(bitcode)),
+          functions_(std::move(functions)), requested_(functions_.size(), false),
+          worker_(&TierUpCompiler::work, this) {}
+
+    // Stops after the function being compiled, the rest of the queue is dropped
+    ~TierUpCompiler() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopped_ = true;
+        }
+        wakeUp_.notify_one();
+        worker_.join();
+    }
+
+    // Called from the JIT-compiled prologues, see instrument()
+    static void request(TierUpCompiler* self, int32_t id) {
+        {
+            std::lock_guard<std::mutex> lock(self->mutex_);
+            if (self->requested_[id])
+                return;
+            self->requested_[id] = true;
+            self->queue_.push_back(id);
+        }
+        self->wakeUp_.notify_one();
+    }
+
+  private:
+    void work() {
+        while (true) {
+            int32_t id;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wakeUp_.wait(lock, [this] { return stopped_ || !queue_.empty(); });
+                if (stopped_)
+                    return;
+                id = queue_.front();
+                queue_.pop_front();
+            }
+            // A failed recompilation leaves the function at tier 0
+            try {
+                compile(functions_[id]);
+            } catch (std::runtime_error& e) {
+                std::cerr << e.what() << std::endl;
+            }
+        }
+    }
+
+    void compile(const std::string& name) {
+        auto context = std::make_unique<LLVMContext>();
+        auto module = throwOnError(parseBitcodeFile(
+            MemoryBufferRef(StringRef(bitcode_.data(), bitcode_.size()), name), *context));
+
+        // The other functions keep their names and resolve to their stubs. Their
+        // bodies are only there to be inlined and are never emitted.
+        for (Function& fn : *module) {
+            if (fn.isDeclaration())
+                continue;
+            if (fn.getName() == name)
+                fn.setName(name + ".tier2");
+            else
+                fn.setLinkage(GlobalValue::AvailableExternallyLinkage);
+        }
+
+        auto targetMachineBuilder =
+            throwOnError(orc::JITTargetMachineBuilder::detectHost());
+        targetMachineBuilder.setCodeGenOptLevel(CodeGenOpt::Aggressive);
+        auto targetMachine = throwOnError(targetMachineBuilder.createTargetMachine());
+        module->setDataLayout(targetMachine->createDataLayout());
+
+        Optimizer(*targetMachine, 3).run(*module);
+        orc::SimpleCompiler compiler(*targetMachine);
+        throwOnError(jit_.addObjectFile(throwOnError(compiler(*module))));
+
+        auto tier2 = throwOnError(jit_.lookup(name + ".tier2"));
+        throwOnError(stubs_.updatePointer(name, tier2.getAddress()));
+    }
+
+    orc::LLJIT& jit_;
+    orc::IndirectStubsManager& stubs_;
+    const SmallVector<char, 0> bitcode_; // The module before instrumentation
+    const std::vector<std::string> functions_;
+
+    std::mutex mutex_;
+    std::condition_variable wakeUp_;
+    std::deque<int32_t> queue_;
+    std::vector<bool> requested_;
+    bool stopped_ = false;
+    std::thread worker_;
+};
+
+// Renames each function F to F.tier0 and redirects all calls to the stub F. The
+// prologue of F.tier0 increments a counter and calls TierUpCompiler::request
+// when it reaches the threshold. Returns the names of the instrumented functions.
+static std::vector<std::string> instrument(Module& module, TierUpCompiler** compiler,
+                                           unsigned threshold) {
+    LLVMContext& context = module.getContext();
+    Type* int32Ty = Type::getInt32Ty(context);
+    Type* int8PtrTy = Type::getInt8PtrTy(context);
+    Type* int64Ty = Type::getInt64Ty(context);
+
+    // The compiler is created after the module is compiled, hence the extra indirection
+    FunctionCallee request = module.getOrInsertFunction(
+        "jlc.tierUp", Type::getVoidTy(context), int8PtrTy, int32Ty);
+    Constant* compilerPtr = ConstantExpr::getIntToPtr(
+        ConstantInt::get(int64Ty, (uint64_t)compiler), PointerType::getUnqual(int8PtrTy));
+
+    std::vector<Function*> bodies;
+    for (Function& fn : module)
+        if (!fn.isDeclaration() && fn.getName() != "main")
+            bodies.push_back(&fn);
+
+    std::vector<std::string> names;
+    for (Function* body : bodies) {
+        std::string name = body->getName().str();
+        int32_t id = names.size();
+        names.push_back(name);
+
+        body->setName(name + ".tier0");
+        Function* stub = Function::Create(body->getFunctionType(),
+                                          GlobalValue::ExternalLinkage, name, module);
+        body->replaceAllUsesWith(stub);
+
+        auto* calls = new GlobalVariable(module, int32Ty, false,
+                                         GlobalValue::InternalLinkage,
+                                         ConstantInt::get(int32Ty, 0), name + ".calls");
+        BasicBlock* entry = &body->getEntryBlock();
+        BasicBlock* prologue = BasicBlock::Create(context, "prologue", body, entry);
+        BasicBlock* tierUp = BasicBlock::Create(context, "tier_up", body, entry);
+
+        IRBuilder<> builder(prologue);
+        Value* count = builder.CreateAtomicRMW(AtomicRMWInst::Add, calls,
+                                               ConstantInt::get(int32Ty, 1), MaybeAlign(4),
+                                               AtomicOrdering::Monotonic);
+        builder.CreateCondBr(
+            builder.CreateICmpEQ(count, ConstantInt::get(int32Ty, threshold - 1)),
+            tierUp, entry);
+        builder.SetInsertPoint(tierUp);
+        builder.CreateCall(request, {builder.CreateLoad(int8PtrTy, compilerPtr),
+                                     ConstantInt::get(int32Ty, id)});
+        builder.CreateBr(entry);
+    }
+    return names;
+}
+
+static int callMain(orc::LLJIT& jit) {
+    auto mainSymbol = throwOnError(jit.lookup("main"));
+    auto mainFn = (int (*)())mainSymbol.getAddress();
+    int result = mainFn();
+    fflush(stdout);
+    return result;
+}
+
+JitRunner::JitRunner(const std::vector<std::string>& runtimePaths, unsigned optLevel,
+                     unsigned tierThreshold)
+    : runtimePaths_(runtimePaths), optLevel_(optLevel), tierThreshold_(tierThreshold) {}
+
+int JitRunner::run(Codegen& codegen) {
+    auto targetMachineBuilder = throwOnError(orc::JITTargetMachineBuilder::detectHost());
+    targetMachineBuilder.setCodeGenOptLevel(optLevel_ == 0 || tierThreshold_ > 0
+                                                ? CodeGenOpt::None
+                                                : CodeGenOpt::Default);
+    Triple triple = targetMachineBuilder.getTargetTriple();
+    auto jit = throwOnError(orc::LLJITBuilder()
+                                .setJITTargetMachineBuilder(std::move(targetMachineBuilder))
+                                .create());
+
+    // printf, scanf, calloc etc. are resolved in the jlc process
+    jit->getMainJITDylib().addGenerator(
+        throwOnError(orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+            jit->getDataLayout().getGlobalPrefix())));
+
+    // A strong definition in a later object (e.g. jlc_alloc) overrides a weak one
+    for (const std::string& path : runtimePaths_) {
+        auto runtime = MemoryBuffer::getFile(path);
+        if (!runtime)
+            throw std::runtime_error("ERROR: Could not read runtime '" + path +
+                                     "': " + runtime.getError().message());
+        throwOnError(jit->addObjectFile(std::move(*runtime)));
+    }
+
+    if (tierThreshold_ == 0) {
+        throwOnError(jit->addIRModule(orc::ThreadSafeModule(std::move(codegen.module_),
+                                                            std::move(codegen.context_))));
+        return callMain(*jit);
+    }
+
+    SmallVector<char, 0> bitcode;
+    raw_svector_ostream bitcodeStream(bitcode);
+    WriteBitcodeToFile(*codegen.module_, bitcodeStream);
+
+    TierUpCompiler* compilerRef = nullptr;
+    std::vector<std::string> functions =
+        instrument(*codegen.module_, &compilerRef, tierThreshold_);
+
+    // The stubs are defined before the module is compiled, and pointed to the tier 0
+    // bodies before main is called
+    auto stubs = orc::createLocalIndirectStubsManagerBuilder(triple)();
+    orc::SymbolMap stubSymbols;
+    for (const std::string& name : functions) {
+        throwOnError(stubs->createStub(name, 0, JITSymbolFlags::Exported));
+        stubSymbols[jit->mangleAndIntern(name)] = stubs->findStub(name, false);
+    }
+    stubSymbols[jit->mangleAndIntern("jlc.tierUp")] = JITEvaluatedSymbol(
+        pointerToJITTargetAddress(&TierUpCompiler::request), JITSymbolFlags::Exported);
+    throwOnError(jit->getMainJITDylib().define(orc::absoluteSymbols(stubSymbols)));
+
+    throwOnError(jit->addIRModule(
+        orc::ThreadSafeModule(std::move(codegen.module_), std::move(codegen.context_))));
+    for (const std::string& name : functions)
+        throwOnError(stubs->updatePointer(
+            name, throwOnError(jit->lookup(name + ".tier0")).getAddress()));
+
+    TierUpCompiler compiler(*jit, *stubs, std::move(bitcode), std::move(functions));
+    compilerRef = &compiler;
+    return callMain(*jit);
+}
+
+} // namespace jlc::codegen
@@ -0,0 +1,30 @@
+#pragma once
+#include "CodeGen.h"
+#include <string>
+#include <vector>
+
+namespace jlc::codegen {
+
+// Runs a program in-process with ORC's LLJIT instead of emitting it.
+// The runtime functions come from the prebuilt runtime objects (lib/runtime.o, and
+// lib/arena.o with --arena), and the C library from the jlc process itself.
+//
+// With a tier threshold the program is first compiled at -O0 (FastISel), and each
+// function that has been called tierThreshold times is recompiled at -O3 on a
+// background thread while the program keeps running.
+class JitRunner {
+  public:
+    JitRunner(const std::vector<std::string>& runtimePaths, unsigned optLevel,
+              unsigned tierThreshold = 0);
+
+    // Takes over the module of codegen, JIT-compiles it and calls main.
+    // Returns the value returned by main.
+    int run(Codegen& codegen);
+
+  private:
+    std::vector<std::string> runtimePaths_;
+    unsigned optLevel_;
+    unsigned tierThreshold_; // 0 if not tiered
+};
+
+} // namespace jlc::codegen
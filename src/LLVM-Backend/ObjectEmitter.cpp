@@ -0,0 +1,96 @@
+#include "ObjectEmitter.h"
+#include "src/Common/Parallel.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/MC/TargetRegistry.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/Program.h"
+#include "llvm/Support/raw_ostream.h"
+#include <list>
+
+namespace jlc::codegen {
+
+using namespace llvm;
+
+ObjectEmitter::ObjectEmitter(TargetMachine& targetMachine, unsigned optLevel)
+    : targetMachine_(targetMachine), optLevel_(optLevel) {
+    targetMachine_.setOptLevel(optLevel == 0   ? CodeGenOpt::None
+                               : optLevel == 1 ? CodeGenOpt::Less
+                               : optLevel == 2 ? CodeGenOpt::Default
+                                               : CodeGenOpt::Aggressive);
+}
+
+void ObjectEmitter::emitObject(Module& m, const std::string& path) {
+    std::error_code error;
+    raw_fd_ostream out(path, error, sys::fs::OF_None);
+    if (error)
+        throw std::runtime_error("ERROR: Could not open '" + path + "': " + error.message());
+
+    // The MC layer is only available through the legacy pass manager
+    legacy::PassManager passManager;
+    if (targetMachine_.addPassesToEmitFile(passManager, out, nullptr, CGFT_ObjectFile))
+        throw std::runtime_error("ERROR: The target can't emit object files");
+
+    passManager.run(m);
+    out.flush();
+}
+
+void ObjectEmitter::emitBitcode(Module& m, const std::string& path) {
+    std::error_code error;
+    raw_fd_ostream out(path, error, sys::fs::OF_None);
+    if (error)
+        throw std::runtime_error("ERROR: Could not open '" + path + "': " + error.message());
+
+    WriteBitcodeToFile(m, out);
+    out.flush();
+}
+
+void ObjectEmitter::emitExecutable(ArrayRef<Module*> modules, const std::string& path,
+                                   const std::vector<std::string>& runtimePaths,
+                                   unsigned jobs) {
+    std::vector<std::string> objectPaths;
+    std::list<FileRemover> removeObjects; // Not movable, so not in a vector
+    for (std::size_t i = 0; i < modules.size(); i++) {
+        SmallString<128> objectPath;
+        if (auto error = sys::fs::createTemporaryFile("jlc", "o", objectPath))
+            throw std::runtime_error("ERROR: Could not create temporary file: " +
+                                     error.message());
+        removeObjects.emplace_back(objectPath);
+        objectPaths.push_back(objectPath.str().str());
+    }
+
+    runInParallel(jobs, modules.size(), [&](std::size_t i) {
+        if (jobs <= 1)
+            return emitObject(*modules[i], objectPaths[i]);
+        // A target machine emits one module at a time, so each gets a copy of it
+        std::unique_ptr<TargetMachine> targetMachine(
+            targetMachine_.getTarget().createTargetMachine(
+                targetMachine_.getTargetTriple().str(), targetMachine_.getTargetCPU(),
+                targetMachine_.getTargetFeatureString(), targetMachine_.Options,
+                targetMachine_.getRelocationModel(), targetMachine_.getCodeModel(),
+                targetMachine_.getOptLevel()));
+        ObjectEmitter(*targetMachine, optLevel_).emitObject(*modules[i], objectPaths[i]);
+    });
+    objectPaths.insert(objectPaths.end(), runtimePaths.begin(), runtimePaths.end());
+    link(objectPaths, path);
+}
+
+void ObjectEmitter::link(const std::vector<std::string>& objectPaths,
+                         const std::string& path) {
+    ErrorOr<std::string> driver = sys::findProgramByName("cc");
+    if (!driver)
+        driver = sys::findProgramByName("clang");
+    if (!driver)
+        throw std::runtime_error("ERROR: No C compiler driver found to link with");
+
+    std::vector<StringRef> args{*driver};
+    args.insert(args.end(), objectPaths.begin(), objectPaths.end());
+    args.insert(args.end(), {"-o", path});
+    std::string errorMsg;
+    if (sys::ExecuteAndWait(*driver, args, None, {}, 0, 0, &errorMsg) != 0)
+        throw std::runtime_error("ERROR: Linking '" + path + "' failed " + errorMsg);
+}
+
+} // namespace jlc::codegen
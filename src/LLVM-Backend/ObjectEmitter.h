@@ -0,0 +1,37 @@
+#pragma once
+#include "llvm/IR/Module.h"
+#include "llvm/Target/TargetMachine.h"
+#include <string>
+#include <vector>
+
+namespace jlc::codegen {
+
+// Emits native code (or bitcode) for a module directly, without the textual IR
+// round-trip through llvm-as / llc.
+class ObjectEmitter {
+  public:
+    ObjectEmitter(llvm::TargetMachine& targetMachine, unsigned optLevel);
+
+    // Writes a relocatable object file.
+    void emitObject(llvm::Module& m, const std::string& path);
+
+    // Streams the module as bitcode to the file, or to std out if path is "-".
+    void emitBitcode(llvm::Module& m, const std::string& path);
+
+    // Writes the modules to temporary object files, on up to jobs threads, and links
+    // them together with the prebuilt runtime objects into an executable, using the
+    // system compiler driver.
+    void emitExecutable(llvm::ArrayRef<llvm::Module*> modules, const std::string& path,
+                        const std::vector<std::string>& runtimePaths, unsigned jobs = 1);
+
+    // Links object files, of separately compiled modules and the runtime, into an
+    // executable
+    static void link(const std::vector<std::string>& objectPaths,
+                     const std::string& path);
+
+  private:
+    llvm::TargetMachine& targetMachine_;
+    unsigned optLevel_;
+};
+
+} // namespace jlc::codegen
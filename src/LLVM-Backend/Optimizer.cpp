@@ -0,0 +1,57 @@
+#include "Optimizer.h"
+#include "BoundsCheckElimination.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Passes/PassBuilder.h"
+
+namespace jlc::codegen {
+
+using namespace llvm;
+
+// Maps -O<n> to the corresponding pass builder level
+static OptimizationLevel toOptimizationLevel(unsigned optLevel) {
+    switch (optLevel) {
+    case 0: return OptimizationLevel::O0;
+    case 1: return OptimizationLevel::O1;
+    case 2: return OptimizationLevel::O2;
+    default: return OptimizationLevel::O3;
+    }
+}
+
+Optimizer::Optimizer(TargetMachine& targetMachine, unsigned optLevel)
+    : targetMachine_(targetMachine), optLevel_(optLevel) {}
+
+void Optimizer::run(Module& m) {
+    if (optLevel_ == 0)
+        return;
+
+    // The passes assume well-formed IR, so catch codegen bugs here instead.
+    if (verifyModule(m, &errs()))
+        throw std::runtime_error("ERROR: LLVM-CodeGen produced an invalid module");
+
+    LoopAnalysisManager lam;
+    FunctionAnalysisManager fam;
+    CGSCCAnalysisManager cgam;
+    ModuleAnalysisManager mam;
+
+    // Passing the target machine gives the passes (e.g. the vectorizers) the
+    // cost model of the host instead of the generic one.
+    PassBuilder passBuilder(&targetMachine_);
+    passBuilder.registerModuleAnalyses(mam);
+    passBuilder.registerCGSCCAnalyses(cgam);
+    passBuilder.registerFunctionAnalyses(fam);
+    passBuilder.registerLoopAnalyses(lam);
+    passBuilder.crossRegisterProxies(lam, fam, cgam, mam);
+
+    // After the loops are simplified, with the array lengths hoisted and merged,
+    // and before SimplifyCFG and the vectorizers
+    passBuilder.registerScalarOptimizerLateEPCallback(
+        [](FunctionPassManager& fpm, OptimizationLevel) {
+            fpm.addPass(BoundsCheckElimination());
+        });
+
+    ModulePassManager mpm =
+        passBuilder.buildPerModuleDefaultPipeline(toOptimizationLevel(optLevel_));
+    mpm.run(m, mam);
+}
+
+} // namespace jlc::codegen
@@ -0,0 +1,22 @@
+#pragma once
+#include "llvm/IR/Module.h"
+#include "llvm/Target/TargetMachine.h"
+
+namespace jlc::codegen {
+
+// Runs LLVM's default optimization pipeline (new pass manager) over a module.
+// -O1 and up promotes the allocas to registers (mem2reg/SROA), and runs instcombine,
+// GVN, LICM, loop unrolling and inlining among others, and removes the bounds checks
+// that are known to pass (see BoundsCheckElimination.h). -O0 leaves the module as is.
+class Optimizer {
+  public:
+    Optimizer(llvm::TargetMachine& targetMachine, unsigned optLevel);
+
+    void run(llvm::Module& m);
+
+  private:
+    llvm::TargetMachine& targetMachine_;
+    unsigned optLevel_;
+};
+
+} // namespace jlc::codegen
@@ -1,6 +1,8 @@
 #include "ProgramBuilder.h"
+#include "CondBuilder.h"
 #include "ExpBuilder.h"
 #include "IndexBuilder.h"
+#include "llvm/Support/TimeProfiler.h"
 
 namespace jlc::codegen {
 
@@ -18,17 +20,12 @@ class DeclBuilder : public VoidVisitor {
     }
     void visitInit(bnfc::Init* p) override {
         ExpBuilder expBuilder(parent_);
-        Type* declType = getLlvmType(declType_, parent_);
-        Value* varPtr = B->CreateAlloca(declType);
         Value* exp = expBuilder.Visit(p->expr_);
-        B->CreateStore(exp, varPtr);
-        ENV->addVar(p->ident_, varPtr);
+        parent_.declareVar(p->ident_, getLlvmType(declType_, parent_), exp);
     }
     void visitNoInit(bnfc::NoInit* p) override {
-        Type* declType = getLlvmType(declType_, parent_);
-        Value* varPtr = B->CreateAlloca(declType);
-        B->CreateStore(getDefaultVal(declType_, parent_), varPtr);
-        ENV->addVar(p->ident_, varPtr);
+        parent_.declareVar(p->ident_, getLlvmType(declType_, parent_),
+                           getDefaultVal(declType_, parent_));
     }
 
   private:
@@ -41,16 +38,17 @@ class FunctionAdder : public VoidVisitor {
     FunctionAdder(Codegen& parent) : parent_(parent) {}
 
     void visitFnDef(bnfc::FnDef* p) override {
-        std::vector<Type*> argsT;
+        std::list<bnfc::Type*> argTypes;
         for (bnfc::Arg* arg : *p->listarg_)
-            argsT.push_back(getLlvmType(((bnfc::Argument*)arg)->type_, parent_));
-
-        auto fnType =
-            FunctionType::get(getLlvmType(p->type_, parent_), argsT, false);
-        Function* fn = Function::Create(
-            fnType, Function::ExternalLinkage, p->ident_, *parent_.module_);
-
-        ENV->addSignature(p->ident_, fn);
+            argTypes.push_back(((bnfc::Argument*)arg)->type_);
+
+        Function* fn = parent_.declareFunction(p->ident_, p->type_, argTypes);
+        if (parent_.options_.gcRoots) {
+            fn->setGC("shadow-stack");
+            // The shadow stack lowering only finds the gcroots of the entry block,
+            // where inlining would no longer leave those of the callee
+            fn->addFnAttr(Attribute::NoInline);
+        }
     }
 
   private:
@@ -61,49 +59,51 @@ class FunctionAdder : public VoidVisitor {
 class AssignmentBuilder : public VoidVisitor {
   public:
     Codegen& parent_;
-    Value* whereToAssign = nullptr;
+    Value* RHSExp = nullptr;
 
     AssignmentBuilder(Codegen& parent) : parent_(parent) {}
 
     void visitAss(bnfc::Ass* p) {
         ExpBuilder expBuilder(parent_);
-        Value* RHSExp = expBuilder.Visit(p->expr_2); // Build RHS
-        Visit(p->expr_1);                          // Build LHS
-        B->CreateStore(RHSExp, whereToAssign);     // *ptr <- expr
+        RHSExp = expBuilder.Visit(p->expr_2); // Build RHS
+        Visit(p->expr_1);                   // Build LHS, and assign
     }
 
     void visitETyped(bnfc::ETyped* p) { Visit(p->expr_); }
 
     void visitEIndex(bnfc::EIndex* p) {
         IndexBuilder indexBuilder(parent_);
-        whereToAssign = indexBuilder.Visit(p);
+        B->CreateStore(RHSExp, indexBuilder.Visit(p)); // *ptr <- expr
     }
 
     // Variable
-    void visitEVar(bnfc::EVar* p) {
-        whereToAssign = ENV->findVar(p->ident_);
-    }
+    void visitEVar(bnfc::EVar* p) { parent_.storeVar(p->ident_, RHSExp); }
 };
 
 /************  Intermediate Builder   ************/
 
-ProgramBuilder::ProgramBuilder(Codegen& parent) : parent_(parent), isLastStmt_(false) {}
+ProgramBuilder::ProgramBuilder(Codegen& parent) : parent_(parent) {}
 
 void ProgramBuilder::visitProgram(bnfc::Program* p) {
+    build(p, 0, p->listtopdef_->size());
+}
+
+void ProgramBuilder::build(bnfc::Program* p, std::size_t first, std::size_t last) {
     // Create the functions before building each
     FunctionAdder fnAdder(parent_);
     for (bnfc::TopDef* fn : *p->listtopdef_)
         fnAdder.Visit(fn);
     // Build the function
-    for (bnfc::TopDef* fn : *p->listtopdef_)
-        Visit(fn);
+    for (std::size_t i = first; i < last && i < p->listtopdef_->size(); i++)
+        Visit((*p->listtopdef_)[i]);
 }
 
 void ProgramBuilder::visitFnDef(bnfc::FnDef* p) {
+    TimeTraceScope trace("Codegen function", p->ident_);
     Function* currentFn = ENV->findFn(p->ident_);
     ENV->setCurrentFn(currentFn);
     BasicBlock* bb = BasicBlock::Create(*parent_.context_, p->ident_ + "_entry", currentFn);
-    B->SetInsertPoint(bb);
+    parent_.enterBlock(bb);
 
     // Push scope of the function to stack
     ENV->enterScope();
@@ -111,9 +111,7 @@ void ProgramBuilder::visitFnDef(bnfc::FnDef* p) {
     // Add the argument variables and their corresponding Value* to current scope.
     auto argIt = currentFn->arg_begin();
     for (bnfc::Arg* arg : *p->listarg_) {
-        Value* argPtr = B->CreateAlloca(argIt->getType());
-        B->CreateStore(argIt, argPtr);
-        ENV->addVar(((bnfc::Argument*)arg)->ident_, argPtr);
+        parent_.declareVar(((bnfc::Argument*)arg)->ident_, argIt->getType(), argIt);
         std::advance(argIt, 1);
     }
 
@@ -131,14 +129,8 @@ void ProgramBuilder::visitFnDef(bnfc::FnDef* p) {
 void ProgramBuilder::visitBlock(bnfc::Block* p) { Visit(p->liststmt_); }
 
 void ProgramBuilder::visitListStmt(bnfc::ListStmt* p) {
-    if (p->empty())
-        return;
-    auto last = p->end() - 1;
-    for (auto stmt = p->begin(); stmt != last; ++stmt)
-        Visit(*stmt);
-    isLastStmt_ = true;
-    Visit(*last);
-    isLastStmt_ = false;
+    for (bnfc::Stmt* stmt : *p)
+        Visit(stmt);
 }
 
 void ProgramBuilder::visitBStmt(bnfc::BStmt* p) {
@@ -161,12 +153,13 @@ void ProgramBuilder::visitRet(bnfc::Ret* p) {
     ExpBuilder expBuilder(parent_);
     Value* exp = expBuilder.Visit(p->expr_);
     B->CreateRet(exp);
-    B->CreateUnreachable();
+    // Whatever follows is never run, and removed with its block by simplifyCFG
+    parent_.enterBlock(parent_.newBasicBlock());
 }
 
 void ProgramBuilder::visitVRet(bnfc::VRet* p) {
     B->CreateRetVoid();
-    B->CreateUnreachable();
+    parent_.enterBlock(parent_.newBasicBlock());
 }
 
 void ProgramBuilder::visitAss(bnfc::Ass* p) {
@@ -175,50 +168,41 @@ void ProgramBuilder::visitAss(bnfc::Ass* p) {
 }
 
 void ProgramBuilder::visitCond(bnfc::Cond* p) {
-    ExpBuilder expBuilder(parent_);
-    Value* cond = expBuilder.Visit(p->expr_);
     BasicBlock* trueBlock = parent_.newBasicBlock();
     BasicBlock* contBlock = parent_.newBasicBlock();
-    B->CreateCondBr(cond, trueBlock, contBlock);
-    B->SetInsertPoint(trueBlock);
+    CondBuilder(parent_).branch(p->expr_, trueBlock, contBlock);
+    parent_.enterBlock(trueBlock);
     Visit(p->stmt_);
     B->CreateBr(contBlock);
-    B->SetInsertPoint(contBlock);
-    if (isLastStmt_)
-        B->CreateUnreachable();
+    parent_.enterBlock(contBlock);
 }
 
 void ProgramBuilder::visitCondElse(bnfc::CondElse* p) {
-    ExpBuilder expBuilder(parent_);
-    Value* cond = expBuilder.Visit(p->expr_);
     BasicBlock* trueBlock = parent_.newBasicBlock();
     BasicBlock* elseBlock = parent_.newBasicBlock();
     BasicBlock* contBlock = parent_.newBasicBlock();
-    B->CreateCondBr(cond, trueBlock, elseBlock);
-    B->SetInsertPoint(trueBlock);
+    CondBuilder(parent_).branch(p->expr_, trueBlock, elseBlock);
+    parent_.enterBlock(trueBlock);
     Visit(p->stmt_1);
     B->CreateBr(contBlock);
-    B->SetInsertPoint(elseBlock);
+    parent_.enterBlock(elseBlock);
     Visit(p->stmt_2);
     B->CreateBr(contBlock);
-    B->SetInsertPoint(contBlock);
-    if (isLastStmt_)
-        B->CreateUnreachable();
+    parent_.enterBlock(contBlock);
 }
 
 void ProgramBuilder::visitWhile(bnfc::While* p) {
-    ExpBuilder expBuilder(parent_);
     BasicBlock* testBlock = parent_.newBasicBlock();
     BasicBlock* trueBlock = parent_.newBasicBlock();
     BasicBlock* contBlock = parent_.newBasicBlock();
-    B->CreateBr(testBlock);       // Connect prev. block with test-block
-    B->SetInsertPoint(testBlock); // Build the test-block
-    Value* cond = expBuilder.Visit(p->expr_);
-    B->CreateCondBr(cond, trueBlock, contBlock);
-    B->SetInsertPoint(trueBlock); // Then start building true-block
+    B->CreateBr(testBlock);              // Connect prev. block with test-block
+    parent_.enterBlock(testBlock, false); // Build the test-block, sealed after the body
+    CondBuilder(parent_).branch(p->expr_, trueBlock, contBlock);
+    parent_.enterBlock(trueBlock); // Then start building true-block
     Visit(p->stmt_);
     B->CreateBr(testBlock); // Always branch back to test-block
-    B->SetInsertPoint(contBlock);
+    ENV->sealBlock(testBlock);
+    parent_.enterBlock(contBlock);
 }
 
 // TODO: Tidy up
@@ -232,54 +216,50 @@ void ProgramBuilder::visitFor(bnfc::For* p) {
     bnfc::Type* bnfcArrayTy = getBNFCType(p->expr_);
     Type* arrayTy = getLlvmType(bnfcArrayTy, parent_);
     Type* itType = getLlvmType(p->type_, parent_);
-    Value* itPtr = B->CreateAlloca(itType);
 
     Value* rhs = expBuilder.Visit(p->expr_); // Ptr to array
-    Value* len = B->CreateGEP(arrayTy->getPointerElementType(), rhs, {ZERO, ZERO});
-    len = B->CreateLoad(INT32_TY, len);
-
-    // Populate the blocks
-    Value* iterator = B->CreateAlloca(INT32_TY);
-    B->CreateStore(ZERO, iterator);
-    B->CreateBr(testBlock);       // Connect prev. block with test-block
-    B->SetInsertPoint(testBlock); // Build the test-block
-    Value* iteratorVal = B->CreateLoad(INT32_TY, iterator);
+    Value* len = parent_.loadLength(rhs);
+    // Ptr to the first element, so that each iteration only offsets it
+    Value* base = B->CreateInBoundsGEP(arrayTy->getPointerElementType(), rhs,
+                                       {ZERO, ONE, ZERO});
+
+    // A counted loop from 0 to len, which the loop vectorizer recognizes, with the
+    // counter as a phi of the test-block that is incremented at the end of the body
+    BasicBlock* entryBlock = B->GetInsertBlock();
+    B->CreateBr(testBlock);               // Connect prev. block with test-block
+    parent_.enterBlock(testBlock, false); // Build the test-block, sealed after the body
+    PHINode* iteratorVal = B->CreatePHI(INT32_TY, 2);
+    iteratorVal->addIncoming(ZERO, entryBlock);
     Value* cond = B->CreateICmpSLT(iteratorVal, len);
-    Value* add = B->CreateAdd(iteratorVal, ONE);
-    B->CreateStore(add, iterator);
     B->CreateCondBr(cond, trueBlock, contBlock);
-    B->SetInsertPoint(trueBlock); // Then start building true-block
-    Value* placeholder = B->CreateGEP(arrayTy->getPointerElementType(), rhs, {ZERO, ONE});
-    placeholder = B->CreateLoad(placeholder);
-    placeholder = B->CreateGEP(placeholder->getType()->getPointerElementType(),
-                               placeholder, {ZERO, iteratorVal});
-    placeholder = B->CreateLoad(placeholder);
-    B->CreateStore(placeholder, itPtr);
+    parent_.enterBlock(trueBlock); // Then start building true-block
+    Value* placeholder = B->CreateInBoundsGEP(itType, base, iteratorVal);
+    placeholder = B->CreateLoad(itType, placeholder);
 
     ENV->enterScope();
-    ENV->addVar(p->ident_, itPtr);
-    if (auto bStmt = dynamic_cast<bnfc::BStmt*>(p->stmt_))
-        Visit(bStmt->blk_);
+    parent_.declareVar(p->ident_, itType, placeholder);
+    if (kindOf(p->stmt_) == NodeKind::BStmt)
+        Visit(static_cast<bnfc::BStmt*>(p->stmt_)->blk_);
     else
         Visit(p->stmt_);
     ENV->exitScope();
 
+    // Below len, so it can't wrap
+    Value* next = B->CreateAdd(iteratorVal, ONE, "", true, true);
+    iteratorVal->addIncoming(next, B->GetInsertBlock());
     B->CreateBr(testBlock); // Always branch back to test-block
-    B->SetInsertPoint(contBlock);
+    ENV->sealBlock(testBlock);
+    parent_.enterBlock(contBlock);
 }
 
 void ProgramBuilder::visitIncr(bnfc::Incr* p) {
-    Value* varPtr = ENV->findVar(p->ident_);
-    Value* var = B->CreateLoad(INT32_TY, varPtr);
-    Value* newVal = B->CreateAdd(var, INT32(1));
-    B->CreateStore(newVal, varPtr);
+    Value* var = parent_.loadVar(p->ident_);
+    parent_.storeVar(p->ident_, B->CreateAdd(var, INT32(1)));
 }
 
 void ProgramBuilder::visitDecr(bnfc::Decr* p) {
-    Value* varPtr = ENV->findVar(p->ident_);
-    Value* var = B->CreateLoad(INT32_TY, varPtr);
-    Value* newVal = B->CreateSub(var, INT32(1));
-    B->CreateStore(newVal, varPtr);
+    Value* var = parent_.loadVar(p->ident_);
+    parent_.storeVar(p->ident_, B->CreateSub(var, INT32(1)));
 }
 
 void ProgramBuilder::visitEmpty(bnfc::Empty* p) {}
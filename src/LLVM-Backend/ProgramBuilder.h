@@ -12,6 +12,9 @@ class ProgramBuilder : public VoidVisitor {
   public:
     ProgramBuilder(Codegen& parent);
     void visitProgram(bnfc::Program* p);
+    // Adds all the function declarations, but only builds the definitions of the
+    // functions first to last (exclusive), for a part of the program (see Codegen::run)
+    void build(bnfc::Program* p, std::size_t first, std::size_t last);
     void visitFnDef(bnfc::FnDef* p);
     void visitBlock(bnfc::Block* p);
     void visitListStmt(bnfc::ListStmt* p);
@@ -31,7 +34,6 @@ class ProgramBuilder : public VoidVisitor {
 
   private:
     Codegen& parent_;
-    bool isLastStmt_;
 };
 
 
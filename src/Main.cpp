@@ -1,57 +1,303 @@
+#include "Common/Options.h"
+#include "Common/Parallel.h"
+#include "Common/PhaseTimers.h"
 #include "Common/Util.h"
 #include "LLVM-Backend/CodeGen.h"
+#include "LLVM-Backend/JitRunner.h"
+#include "LLVM-Backend/ObjectEmitter.h"
+#include "LLVM-Backend/Optimizer.h"
+#include "Frontend/CallGraph.h"
+#include "Frontend/ConstantFolder.h"
 #include "Frontend/Parser.h"
 #include "Frontend/TypeChecker.h"
+#include <fstream>
 #include <iostream>
+#include <sstream>
 
 using namespace jlc;
 using namespace jlc::typechecker;
 using namespace jlc::codegen;
 namespace fs = std::filesystem;
 
-int main(int argc, char** argv) {
-    FILE* input = nullptr;
+// A source file, which is compiled into a module of its own
+struct Source {
+    std::string file; // Empty for std in
+    Parser parser;
+    TypeChecker typeChecker;
+    typechecker::ConstantFolder constantFolder; // Not llvm::ConstantFolder
+    // The module, built in parts with -j, which are then linked into the first one
+    std::vector<std::unique_ptr<Codegen>> codegens;
 
-    try {
-        input = readFileOrInput(argv[1]);
-    } catch(std::exception& e) {
-        std::cerr << "ERROR: Failed to read source file" << std::endl;
+    // The output file named after it, in the current directory like cc -c
+    std::string outputFile(const char* extension) const {
+        return outputFileFor(file.empty() ? "a" : file, extension);
     }
-    Parser parser;
+};
 
-    try {
-        parser.run(input);
-    } catch (bnfc::parse_error& e) {
-        std::cerr << "ERROR: Parse error on line " << e.getLine() << std::endl;
-        return 1;
-    } catch(std::exception& e) {
-        return 1;
+// --time-report prints the tables on stderr, --time-report=<file> writes them as JSON
+static void reportTimes(PhaseTimers& timers, const Options& options) {
+    if (!options.timeReport)
+        return;
+    if (options.timeReportFile.empty()) {
+        timers.print(llvm::errs());
+        return;
+    }
+    std::error_code error;
+    llvm::raw_fd_ostream os(options.timeReportFile, error);
+    if (error) {
+        std::cerr << "ERROR: Could not write '" << options.timeReportFile
+                  << "': " << error.message() << std::endl;
+        return;
     }
+    timers.printJSON(os);
+}
 
-    TypeChecker typeChecker;
+// --trace <file> writes the events recorded since main started, for chrome://tracing
+// or Perfetto
+static void writeTrace(const Options& options) {
+    if (options.traceFile.empty())
+        return;
+    if (llvm::Error error = llvm::timeTraceProfilerWrite(options.traceFile, "jlc"))
+        std::cerr << "ERROR: Could not write '" << options.traceFile
+                  << "': " << llvm::toString(std::move(error)) << std::endl;
+    llvm::timeTraceProfilerCleanup();
+}
+
+// Builds a module of each source, and emits (or runs) them. Returns the exit code of
+// the program with --run.
+static int runBackend(std::vector<std::unique_ptr<Source>>& sources,
+                      const Options& options, PhaseTimers& timers) {
+    PhaseTimers::Scope backend(timers, "backend", "Backend");
+    // An executable is linked from an object of each part, the rest needs one module
+    bool linkParts = options.run || options.compileOnly || options.emitBitcode ||
+                     options.outputFile.empty();
+    for (auto& source : sources) {
+        // With -j the functions are split in consecutive parts, which are built and
+        // optimized each on a thread, in a Codegen (LLVMContext, module and builder)
+        // of its own that declares all of them
+        bnfc::Prog* p = source->typeChecker.getAbsyn();
+        std::size_t functions = static_cast<bnfc::Program*>(p)->listtopdef_->size();
+        std::size_t parts = std::max<std::size_t>(1, std::min<std::size_t>(options.jobs,
+                                                                           functions));
+        CodegenOptions codegenOptions{!options.gcFile.empty(), options.boundsCheck};
+        for (std::size_t i = 0; i < parts; i++) {
+            auto codegen = std::make_unique<Codegen>(source->file, codegenOptions);
+            for (const Signature& fn : source->typeChecker.getImports())
+                codegen->declareFunction(fn.name, fn.type.ret, fn.type.args);
+            source->codegens.push_back(std::move(codegen));
+        }
+        {
+            PhaseTimers::Scope phase(timers, "codegen", "Codegen");
+            runInParallel(options.jobs, parts, [&](std::size_t i) {
+                source->codegens[i]->run(p, functions * i / parts,
+                                         functions * (i + 1) / parts);
+            });
+        }
+        {
+            PhaseTimers::Scope phase(timers, "optimize", "Optimize");
+            runInParallel(options.jobs, parts, [&](std::size_t i) {
+                Codegen& codegen = *source->codegens[i];
+                // Tiered, the JIT starts at -O0 and optimizes the hot functions itself
+                Optimizer optimizer(codegen.getTargetMachineRef(),
+                                    options.tierThreshold ? 0 : options.optLevel);
+                optimizer.run(codegen.getModuleRef());
+            });
+        }
+        if (linkParts && parts > 1) {
+            PhaseTimers::Scope phase(timers, "link", "Link parts");
+            for (std::size_t i = 1; i < parts; i++)
+                source->codegens[0]->link(*source->codegens[i]);
+            source->codegens.resize(1);
+        }
+    }
+
+    Codegen& first = *sources.front()->codegens.front();
+    if (options.run) {
+        PhaseTimers::Scope phase(timers, "run", "JIT and run");
+        std::cerr << "OK" << std::endl;
+        JitRunner jit(runtimeFiles(options), options.optLevel, options.tierThreshold);
+        return jit.run(first);
+    }
+
+    PhaseTimers::Scope phase(timers, "emit", "Emit");
+    ObjectEmitter emitter(first.getTargetMachineRef(), options.optLevel);
+    if (options.compileOnly) {
+        // With several sources, each one's file is named after it
+        const char* extension = options.emitBitcode ? "bc" : "o";
+        for (auto& source : sources) {
+            std::string file = sources.size() == 1 ? options.outputFile
+                                                   : source->outputFile(extension);
+            if (options.emitBitcode)
+                emitter.emitBitcode(source->codegens.front()->getModuleRef(), file);
+            else
+                emitter.emitObject(source->codegens.front()->getModuleRef(), file);
+        }
+    } else if (options.emitBitcode) {
+        emitter.emitBitcode(first.getModuleRef(),
+                            options.outputFile.empty() ? "-" : options.outputFile);
+    } else if (!options.outputFile.empty()) {
+        std::vector<llvm::Module*> modules;
+        for (auto& source : sources)
+            for (auto& codegen : source->codegens)
+                modules.push_back(&codegen->getModuleRef());
+        emitter.emitExecutable(modules, options.outputFile, runtimeFiles(options),
+                               options.jobs);
+    } else { // Stream the IR, without buffering the whole module as a string
+        first.getModuleRef().print(llvm::outs(), nullptr);
+    }
+    llvm::outs().flush();
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    Options options;
 
     try {
-        typeChecker.run(parser.getAbsyn());
-    } catch(TypeError& t) {
-        std::cerr << t.what() << std::endl;
+        options = parseOptions(argc, argv);
+    } catch (std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
         return 1;
     }
 
-    Codegen codegen;
+    // 'jlc -o prog main.o lib.o' only links the separately compiled modules
+    if (options.inputFiles.empty() && !options.objectFiles.empty() && !options.run) {
+        try {
+            ObjectEmitter::link(runtimeFiles(options), options.outputFile);
+        } catch(std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        std::cerr << "OK" << std::endl;
+        return 0;
+    }
+
+    std::vector<std::unique_ptr<Source>> sources;
+    for (const std::string& file : options.inputFiles) {
+        sources.push_back(std::make_unique<Source>());
+        sources.back()->file = file;
+    }
+    if (sources.empty())
+        sources.push_back(std::make_unique<Source>());
+    // A single source that doesn't call other modules is the whole program, which
+    // needs a main and only keeps the functions that main calls
+    bool wholeProgram = sources.size() == 1 && options.interfaceFiles.empty() &&
+                        options.objectFiles.empty() && !options.compileOnly &&
+                        !options.emitInterface;
+
+    // The interfaces of the other modules, read in full before parsing
+    std::vector<std::pair<std::string, std::string>> interfaces; // File, text
+    for (const std::string& file : options.interfaceFiles) {
+        std::ifstream is(file);
+        std::stringstream text;
+        text << is.rdbuf();
+        if (!is) {
+            std::cerr << "ERROR: Failed to read interface file '" << file << "'"
+                      << std::endl;
+            return 1;
+        }
+        interfaces.emplace_back(file, text.str());
+    }
+
+    if (!options.traceFile.empty())
+        llvm::timeTraceProfilerInitialize(traceGranularity, "jlc");
+    PhaseTimers timers(options.timeReport);
+    {
+        PhaseTimers::Scope frontend(timers, "frontend", "Frontend");
+
+        for (auto& source : sources) {
+            FILE* input = nullptr;
+            try {
+                input = readFileOrInput(source->file.empty() ? nullptr
+                                                             : source->file.c_str());
+            } catch(std::exception& e) {
+                std::cerr << "ERROR: Failed to read source file" << std::endl;
+                return 1;
+            }
+
+            try {
+                PhaseTimers::Scope phase(timers, "parse", "Parse");
+                source->parser.run(input);
+            } catch (bnfc::parse_error& e) {
+                std::cerr << "ERROR: Parse error on line " << e.getLine();
+                if (sources.size() > 1)
+                    std::cerr << " of '" << source->file << "'";
+                std::cerr << std::endl;
+                return 1;
+            } catch(std::exception& e) {
+                return 1;
+            }
+        }
+
+        // The sources call each other through their interfaces, like separately
+        // compiled modules
+        std::vector<std::string> sourceInterfaces;
+        for (auto& source : sources) {
+            std::ostringstream text;
+            writeInterface(text, source->parser.getAbsyn());
+            sourceInterfaces.push_back(text.str());
+        }
+
+        for (std::size_t i = 0; i < sources.size(); i++) {
+            Source& source = *sources[i];
+            try {
+                PhaseTimers::Scope phase(timers, "typecheck", "Typecheck");
+                for (std::size_t j = 0; j < sources.size(); j++)
+                    if (j != i) {
+                        std::istringstream text(sourceInterfaces[j]);
+                        source.typeChecker.import(text, sources[j]->file);
+                    }
+                for (auto& [file, interface] : interfaces) {
+                    std::istringstream text(interface);
+                    source.typeChecker.import(text, file);
+                }
+                source.typeChecker.run(source.parser.getAbsyn(), wholeProgram);
+            } catch(TypeError& t) {
+                if (sources.size() > 1)
+                    std::cerr << "In '" << source.file << "':" << std::endl;
+                std::cerr << t.what() << std::endl;
+                return 1;
+            }
+
+            {
+                PhaseTimers::Scope phase(timers, "fold", "Constant folding");
+                source.constantFolder.run(source.typeChecker.getAbsyn());
+            }
+
+            if (wholeProgram) {
+                PhaseTimers::Scope phase(timers, "prune", "Dead function elimination");
+                removeDeadFunctions(source.typeChecker.getAbsyn());
+            }
+        }
+    }
+
+    if (options.emitInterface) {
+        for (auto& source : sources) {
+            std::string file = source->outputFile("jli");
+            std::ofstream os(file);
+            writeInterface(os, source->typeChecker.getAbsyn());
+            if (!os) {
+                std::cerr << "ERROR: Could not write '" << file << "'" << std::endl;
+                return 1;
+            }
+        }
+    }
+    // Only the interfaces, which a build can compare to find the modules to rebuild
+    bool interfacesOnly = options.emitInterface && !options.compileOnly &&
+                          !options.emitBitcode && !options.run &&
+                          options.outputFile.empty();
+
+    int exitCode = 0;
     try {
-        codegen.run(typeChecker.getAbsyn());
+        if (!interfacesOnly)
+            exitCode = runBackend(sources, options, timers);
     } catch(std::runtime_error& e) {
         std::cerr << e.what() << std::endl;
         return 1;
     }
 
-    llvm::Module& m = codegen.getModuleRef();
-    std::string out;
-    llvm::raw_string_ostream outStream(out);
-    m.print(outStream, nullptr);
-    std::cout << out;
-
-
-    std::cerr << "OK" << std::endl;
-    return 0;
+    if (!options.run)
+        std::cerr << "OK" << std::endl;
+    reportTimes(timers, options);
+    writeTrace(options);
+    return exitCode;
 }
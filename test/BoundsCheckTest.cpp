@@ -0,0 +1,34 @@
+#include "TestUtil.h"
+
+// Builds the programs with jlc --bounds-check -o
+class BoundsCheck : public JlcTest {
+  protected:
+    int build(const std::string& flags, const char* file) {
+        return run(jlc() + "--bounds-check " + flags + " -o prog " + quoted(file));
+    }
+};
+
+TEST_F(BoundsCheck, ExitsOnIndexOutOfBounds) {
+    for (const char* flags : {"-O0", "-O2"}) {
+        ASSERT_EQ(build(flags, "test-files/bounds/outofbounds.jl"), 0) << err();
+        EXPECT_EQ(run("./prog"), 1) << flags;
+        // The indices before it are printed
+        EXPECT_EQ(out(), "0\n5\n") << flags;
+        EXPECT_EQ(err(), "ERROR: Index 10 out of bounds for length 10\n") << flags;
+    }
+}
+
+// The checks of a[i] in while (i < a.length) are removed from -O1 up, which must not
+// change what the program does
+TEST_F(BoundsCheck, EliminatedChecksKeepOutput) {
+    const char* file = "test-files/bounds/lengthloop.jl";
+    for (const char* flags : {"-O0", "-O2"}) {
+        ASSERT_EQ(build(flags, file), 0) << err();
+        EXPECT_EQ(run("./prog"), 0) << flags;
+        EXPECT_EQ(out(), readText("test-files/bounds/lengthloop.output")) << flags;
+    }
+
+    // None of the checks are left in the optimized IR
+    ASSERT_EQ(run(jlc() + "--bounds-check -O2 " + quoted(file)), 0);
+    EXPECT_EQ(out().find("call void @indexOutOfBounds"), std::string::npos);
+}
@@ -0,0 +1,19 @@
+#include "TestUtil.h"
+
+// Builds the programs with jlc --gc -o, at the levels that inline
+class Gc : public JlcTest {
+  protected:
+    int build(const std::string& flags, const char* file) {
+        return run(jlc() + "--gc " + flags + " -o prog " + quoted(file));
+    }
+};
+
+// The roots of inlined functions must stay where the shadow stack lowering finds them
+TEST_F(Gc, ArraysAtEachLevel) {
+    const char* file = "test-files/gc/arrays.jl";
+    for (const char* flags : {"-O0", "-O2", "-O3"}) {
+        ASSERT_EQ(build(flags, file), 0) << flags << err();
+        EXPECT_EQ(run("./prog"), 0) << flags;
+        EXPECT_EQ(out(), readText("test-files/gc/arrays.output")) << flags;
+    }
+}
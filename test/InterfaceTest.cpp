@@ -0,0 +1,109 @@
+#include "TestUtil.h"
+#include "src/Common/Util.h"
+#include "src/Frontend/Interface.h"
+#include "src/Frontend/Parser.h"
+#include "src/Frontend/TypeChecker.h"
+
+using namespace jlc;
+using namespace jlc::typechecker;
+
+static const char* libFile = "test-files/separate/lib.jl";
+static const char* mainFile = "test-files/separate/main.jl";
+
+TEST(Interface, RoundTrip) {
+
+    Parser parser;
+    ASSERT_NO_THROW({
+        parser.run(readFileOrInput(libFile));
+    });
+
+    // A module on its own, without a main
+    TypeChecker typeChecker;
+    ASSERT_NO_THROW({
+        typeChecker.run(parser.getAbsyn(), false);
+    });
+
+    std::ostringstream written;
+    writeInterface(written, typeChecker.getAbsyn());
+    EXPECT_EQ(written.str(), "int sum(int[]);\n"
+                             "double[][] identity(int);\n"
+                             "boolean isEven(int);\n"
+                             "boolean isOdd(int);\n"
+                             "void greet();\n");
+
+    // The types read back are the canonical ones the type checker gave the functions
+    std::istringstream text(written.str());
+    std::vector<Signature> signatures;
+    ASSERT_NO_THROW({
+        signatures = readInterface(text, "lib.jli", typeChecker.getEnv().types());
+    });
+    std::vector<std::string> names{"sum", "identity", "isEven", "isOdd", "greet"};
+    ASSERT_EQ(signatures.size(), names.size());
+    for (std::size_t i = 0; i < names.size(); i++) {
+        EXPECT_EQ(signatures[i].name, names[i]);
+        FunctionType fn = typeChecker.getEnv().findFn(names[i], 0, 0);
+        EXPECT_EQ(signatures[i].type.ret, fn.ret);
+        EXPECT_EQ(signatures[i].type.args, fn.args);
+    }
+}
+
+TEST(Interface, SkipsCommentsAndBlankLines) {
+
+    Arena arena;
+    TypeTable types(arena);
+    std::istringstream text("// The interface of lib\n"
+                            "\n"
+                            "  int   f ( int[][] ,double ) ;  // f\n");
+    std::vector<Signature> signatures = readInterface(text, "lib.jli", types);
+    ASSERT_EQ(signatures.size(), 1u);
+    EXPECT_EQ(signatures[0].name, "f");
+    EXPECT_EQ(signatures[0].type.ret, types.get(TypeCode::INT));
+    std::list<Type*> args{types.array(types.get(TypeCode::INT), 2),
+                          types.get(TypeCode::DOUBLE)};
+    EXPECT_EQ(signatures[0].type.args, args);
+}
+
+TEST(Interface, RejectsInvalidSignatures) {
+
+    Arena arena;
+    TypeTable types(arena);
+    for (const char* line : {"int f(int x);", "int f(void);", "string f();", "int f()",
+                             "int f(int,);", "f(int);", "int f(int); int g();"}) {
+        std::istringstream text(std::string("void ok();\n") + line + "\n");
+        try {
+            readInterface(text, "bad.jli", types);
+            ADD_FAILURE() << "Accepted '" << line << "'";
+        } catch (TypeError& e) {
+            EXPECT_NE(std::string(e.what()).find("line 2 of interface 'bad.jli'"),
+                      std::string::npos)
+                << e.what();
+        }
+    }
+}
+
+// Builds main.jl against the interface of lib.jl, each with jlc -c, and links the
+// objects with jlc -o
+class SeparateCompilation : public JlcTest {};
+
+TEST_F(SeparateCompilation, LinksObjects) {
+
+    std::string lib = quoted(libFile);
+    std::string main = quoted(mainFile);
+    std::string expected = readText("test-files/separate/main.output");
+
+    ASSERT_EQ(run(jlc() + "--emit-interface " + lib), 0) << err();
+    EXPECT_TRUE(fs::exists(dir_ / "lib.jli"));
+    ASSERT_EQ(run(jlc() + "-c " + main + " lib.jli"), 0) << err();
+    ASSERT_EQ(run(jlc() + "-c " + lib), 0) << err();
+    ASSERT_EQ(run(jlc() + "-o prog main.o lib.o"), 0) << err();
+    ASSERT_EQ(run("./prog"), 0);
+    EXPECT_EQ(out(), expected);
+
+    // Both sources at once, each a module of its own
+    ASSERT_EQ(run(jlc() + "-o prog2 " + main + " " + lib), 0) << err();
+    ASSERT_EQ(run("./prog2"), 0);
+    EXPECT_EQ(out(), expected);
+
+    // Without the interface, main doesn't know the functions of lib
+    EXPECT_NE(run(jlc() + "-c " + main), 0);
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+// Reads a whole file, or the empty string if there is none
+inline std::string readText(const fs::path& path) {
+    std::ifstream is(path);
+    std::stringstream text;
+    text << is.rdbuf();
+    return text.str();
+}
+
+// The absolute path of a file, quoted for the shell
+inline std::string quoted(const fs::path& path) {
+    return "'" + fs::absolute(path).string() + "'";
+}
+
+// Runs jlc and the programs it builds in a directory of their own, with the output in
+// out.txt and err.txt. The directory is removed after each test, also a failed one.
+class JlcTest : public ::testing::Test {
+  protected:
+    fs::path dir_ = fs::temp_directory_path() /
+                    ("jlc-test-" + std::to_string(::getpid()));
+
+    void SetUp() override { fs::create_directories(dir_); }
+    void TearDown() override { fs::remove_all(dir_); }
+
+    // The exit code of the command, run in dir_
+    int run(const std::string& command) {
+        std::string line = "cd '" + dir_.string() + "' && " + command +
+                           " > out.txt 2> err.txt";
+        int status = std::system(line.c_str());
+        return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    }
+
+    // The start of a command running jlc
+    std::string jlc() { return quoted(JLC_PATH) + " "; }
+
+    std::string out() { return readText(dir_ / "out.txt"); }
+    std::string err() { return readText(dir_ / "err.txt"); }
+};
@@ -30,7 +30,7 @@ class TypeCheckerVisitor : public BaseVisitor {
 
     }
 
-    void visitArgument(Argument *argument)
+    void visitArgument(bnfc::Argument *argument)
     {
         /* Code For Argument Goes Here */
 
@@ -71,10 +71,11 @@ class TypeCheckerVisitor : public BaseVisitor {
 
     void visitAss(Ass *ass)
     {
-        ASSERT_TRUE(dynamic_cast<ETyped*>(ass->expr_));
+        ASSERT_TRUE(dynamic_cast<ETyped*>(ass->expr_1));
+        ASSERT_TRUE(dynamic_cast<ETyped*>(ass->expr_2));
         /* Code For Ass Goes Here */
-        visitIdent(ass->ident_);
-        if (ass->expr_) ass->expr_->accept(this);
+        if (ass->expr_1) ass->expr_1->accept(this);
+        if (ass->expr_2) ass->expr_2->accept(this);
 
     }
 
@@ -516,6 +517,5 @@ TEST(TypeChecker, ReturnsAnnotatedTree) {
     TypeCheckerVisitor vis;
     bnfc::Prog *prog = typeChecker.getAbsyn();
     prog->accept(&vis);
-
-    delete prog;
+    // The tree is owned by the arenas of parser and typeChecker, see Arena.h
 }
\ No newline at end of file
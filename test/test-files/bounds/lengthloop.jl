@@ -0,0 +1,20 @@
+int main() {
+    int[] a = new int[100];
+    int i = 0;
+    while (i < a.length) {
+        a[i] = i * i;
+        i++;
+    }
+    int s = 0;
+    i = 0;
+    while (i < a.length) {
+        s = s + a[i];
+        i++;
+    }
+    printInt(s);
+    double[] d = new double[3];
+    for (double x : d)
+        s = s - 1;
+    printInt(s);
+    return 0;
+}
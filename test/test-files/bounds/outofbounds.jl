@@ -0,0 +1,10 @@
+int main() {
+    int[] a = new int[10];
+    int i = 0;
+    while (i <= a.length) {
+        a[i] = i;
+        printInt(a[i]);
+        i = i + 5;
+    }
+    return 0;
+}
@@ -0,0 +1,47 @@
+// Small functions taking arrays, which -O2 would inline into the loops of main, and
+// enough garbage for a few collections while the kept arrays are still in use
+
+int first(int[] a) {
+  return a[0];
+}
+
+int[] filled(int n, int x) {
+  int[] a = new int[n];
+  int i = 0;
+  while (i < n) {
+    a[i] = x;
+    i++;
+  }
+  return a;
+}
+
+int sum(int[] a) {
+  int s = 0;
+  for (int x : a)
+    s = s + x;
+  return s;
+}
+
+int main() {
+  int[] kept = filled(10, 3);
+  int[][] rows = new int[4][5];
+  int i = 0;
+  int s = 0;
+  while (i < 100) {
+    int[] garbage = filled(100000, i);
+    s = s + first(garbage) + first(kept);
+    rows[i % 4] = filled(5, i);
+    i++;
+  }
+  // Unrolled, with the inlined roots of first in the loop body
+  int j = 0;
+  while (j < 3) {
+    s = s + first(kept);
+    j++;
+  }
+  printInt(s);
+  printInt(sum(kept));
+  for (int[] row : rows)
+    printInt(sum(row));
+  return 0;
+}
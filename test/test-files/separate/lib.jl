@@ -0,0 +1,32 @@
+int sum(int[] a) {
+    int s = 0;
+    for (int x : a)
+        s = s + x;
+    return s;
+}
+
+double[][] identity(int n) {
+    double[][] m = new double[n][n];
+    int i = 0;
+    while (i < n) {
+        m[i][i] = 1.0;
+        i++;
+    }
+    return m;
+}
+
+boolean isEven(int n) {
+    if (n == 0)
+        return true;
+    return isOdd(n - 1);
+}
+
+boolean isOdd(int n) {
+    if (n == 0)
+        return false;
+    return isEven(n - 1);
+}
+
+void greet() {
+    printString("hello from lib");
+}
@@ -0,0 +1,15 @@
+int main() {
+    int[] a = new int[10];
+    int i = 0;
+    while (i < a.length) {
+        a[i] = i;
+        i++;
+    }
+    printInt(sum(a));
+    double[][] m = identity(3);
+    printDouble(m[1][1] + m[1][2]);
+    if (isEven(10))
+        printString("even");
+    greet();
+    return 0;
+}
@@ -0,0 +1,41 @@
+// Variables read after an if/else where only one of the branches writes them.
+int main() {
+	branches(true);
+	branches(false);
+	return 0;
+}
+
+void branches(boolean c) {
+	int x = 1;
+	int y = 10;
+	if (c)
+		x = 5;
+	else
+		y = 20;
+	printInt(x);
+	printInt(y);
+
+	double d = 1.5;
+	if (!c) {
+		d = d * 2.0;
+	}
+	printDouble(d);
+
+	boolean flag = false;
+	if (c) {
+		flag = true;
+	} else {
+	}
+	if (flag)
+		printString("flag");
+	else
+		printString("no flag");
+
+	int z = 0;
+	if (c) {
+	} else {
+		if (x == 1)
+			z = 7;
+	}
+	printInt(z + x);
+}
@@ -0,0 +1,95 @@
+// Constant expressions, which are evaluated by the compiler, print the same as the
+// same expressions computed at run time.
+int main() {
+	// Integers wrap around at 32 bits
+	printInt(2147483647 + 1);
+	printInt(add(2147483647, 1));
+	printInt(-2147483647 - 1 - 1);
+	printInt(sub(sub(-2147483647, 1), 1));
+	printInt(65536 * 65536 + 7);
+	printInt(mul(65536, 65536) + 7);
+	printInt(-(-2147483647 - 1));
+	printInt(sub(0, sub(-2147483647, 1)));
+	printInt(-7 / 2);
+	printInt(div(-7, 2));
+	printInt(-7 % 2);
+	printInt(mod(-7, 2));
+
+	// Divisions that would trap are left to run time, where they aren't reached
+	if (never())
+		printInt(1 / 0);
+	if (never())
+		printInt((-2147483647 - 1) / -1);
+	if (never())
+		printInt((-2147483647 - 1) % -1);
+	printString("no trap");
+
+	// Doubles compare ordered, so even != is false when one of them is NaN
+	if (0.0 / 0.0 != 0.0 / 0.0)
+		printString("NaN != NaN");
+	else
+		printString("not NaN != NaN");
+	if (ddiv(0.0, 0.0) != ddiv(0.0, 0.0))
+		printString("NaN != NaN");
+	else
+		printString("not NaN != NaN");
+	if (0.0 / 0.0 == 0.0 / 0.0)
+		printString("NaN == NaN");
+	else
+		printString("not NaN == NaN");
+	if (1.0 / 0.0 != 2.5)
+		printString("inf != 2.5");
+	printDouble(1.5 * 4.0 - 0.5);
+	printDouble(ddiv(1.5, 0.25) - 0.5);
+
+	// A declaration in a branch on a constant is kept
+	if (true)
+		int x = 5;
+	printInt(x);
+	if (2 > 3) {
+	} else
+		int y = x + 1;
+	printInt(y);
+
+	// Loops that never run
+	while (false)
+		printString("never");
+	int n = 0;
+	while (1 > 2)
+		n++;
+	printInt(n);
+
+	if (true && !false || never())
+		printString("and, or");
+	if (false && never())
+		printString("never");
+	return 0;
+}
+
+int add(int a, int b) {
+	return a + b;
+}
+
+int sub(int a, int b) {
+	return a - b;
+}
+
+int mul(int a, int b) {
+	return a * b;
+}
+
+int div(int a, int b) {
+	return a / b;
+}
+
+int mod(int a, int b) {
+	return a % b;
+}
+
+double ddiv(double a, double b) {
+	return a / b;
+}
+
+boolean never() {
+	return false;
+}
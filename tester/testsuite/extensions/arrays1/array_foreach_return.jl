@@ -0,0 +1,40 @@
+// Loops over arrays that return from, and end with an if-statement in, their body.
+int main() {
+	int[] a = new int[5];
+	int i = 0;
+	while (i < a.length) {
+		a[i] = i * i - 3;
+		i++;
+	}
+	printInt(firstPositive(a));
+	printInt(firstAbove(a, 100));
+	int odd = 0;
+	for (int x : a)
+		if (x % 2 != 0)
+			odd++;
+	printInt(odd);
+	int sum = 0;
+	for (int x : a) {
+		for (int y : a) {
+			if (x < y)
+				sum = sum + 1;
+		}
+	}
+	printInt(sum);
+	return 0;
+}
+
+int firstPositive(int[] a) {
+	for (int x : a) {
+		if (x > 0)
+			return x;
+	}
+	return 0;
+}
+
+int firstAbove(int[] a, int limit) {
+	for (int x : a)
+		if (x > limit)
+			return x;
+	return -1;
+}
@@ -0,0 +1,34 @@
+// An if-statement as the last statement of a loop body must still jump back to
+// the loop condition, whichever branch is taken.
+int main() {
+	int i = 0;
+	int evens = 0;
+	while (i < 10) {
+		i++;
+		if (i % 2 == 0)
+			evens++;
+	}
+	printInt(i);
+	printInt(evens);
+
+	int j = 0;
+	int s = 0;
+	while (j < 5) {
+		j++;
+		if (j > 2)
+			s = s + j;
+		else
+			s = s - 1;
+	}
+	printInt(s);
+
+	int k = 0;
+	while (k < 3) {
+		k++;
+		if (k == 2) {
+			printString("two");
+		}
+	}
+	printInt(k);
+	return 0;
+}
@@ -0,0 +1,54 @@
+// Returning from inside a loop body, with the loop variables still live after it.
+int main() {
+	printInt(firstDivisor(91));
+	printInt(firstDivisor(13));
+	printInt(countUp(3));
+	printUntil(5);
+	printInt(nested(4));
+	return 0;
+}
+
+int firstDivisor(int n) {
+	int d = 2;
+	while (d < n) {
+		if (n % d == 0)
+			return d;
+		d++;
+	}
+	return n;
+}
+
+int countUp(int n) {
+	while (true) {
+		n = n + 4;
+		if (n > 10) {
+			return n;
+		}
+	}
+	return 0;
+}
+
+void printUntil(int stop) {
+	int i = 0;
+	while (i < 10) {
+		if (i == stop)
+			return;
+		printInt(i);
+		i = i + 2;
+	}
+	printString("never");
+}
+
+int nested(int n) {
+	int i = 0;
+	while (i < n) {
+		int j = 0;
+		while (j < n) {
+			if (i * j == 6)
+				return i * 10 + j;
+			j++;
+		}
+		i++;
+	}
+	return -1;
+}
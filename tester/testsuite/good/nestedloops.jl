@@ -0,0 +1,49 @@
+// Variables assigned in an inner loop are read by the outer loop and after both.
+int main() {
+	int i = 0;
+	int count = 0;
+	int last = -1;
+	while (i < 4) {
+		int j = 0;
+		while (j < i) {
+			count = count + j;
+			last = i * 10 + j;
+			j++;
+		}
+		i++;
+	}
+	printInt(count);
+	printInt(last);
+
+	int n = 27;
+	int steps = 0;
+	while (n > 1) {
+		while (n % 2 == 0) {
+			n = n / 2;
+			steps++;
+		}
+		if (n > 1) {
+			n = 3 * n + 1;
+			steps++;
+		}
+	}
+	printInt(n);
+	printInt(steps);
+
+	int a = 1;
+	int b = 1;
+	int rounds = 0;
+	while (rounds < 3) {
+		int inner = 0;
+		while (inner < 4) {
+			int t = a + b;
+			a = b;
+			b = t;
+			inner++;
+		}
+		rounds++;
+	}
+	printInt(a);
+	printInt(b);
+	return 0;
+}